@@ -0,0 +1,40 @@
+#ifndef FRAME_POLICY
+#define FRAME_POLICY
+
+#include "solver.h"
+#include "trace-format.h"
+
+#include <memory>
+#include <vector>
+#include <z3++.h>
+
+namespace pdr
+{
+    // the encoding of the frames F_1.. in solvers, a template argument of
+    // Frames and PDR. F_0 (I) always has a solver of its own.
+    // a policy holds the state of its encoding, the members of Frames that
+    // depend on it are specialized in frames-{name}.cpp. a new encoding adds
+    // a policy, specializes these members and is instantiated in frames.cpp,
+    // pdr.cpp and the other sources of PDR
+
+    // every frame has its own solver, in which all its cubes are blocked
+    struct FatPolicy
+    {
+        static constexpr const char* name   = "fat";
+        static constexpr trace::Event check = trace::Event::check_fat;
+    };
+
+    // all frames share one solver. a cube is only stored in the last frame
+    // that blocks it, its clause in the solver is guarded by the act literal
+    // of that frame. a query on F_i assumes act_i..act_k
+    struct DeltaPolicy
+    {
+        static constexpr const char* name   = "delta";
+        static constexpr trace::Event check = trace::Event::check_delta;
+
+        std::unique_ptr<Solver> solver;
+        std::vector<z3::expr> act;
+    };
+} // namespace pdr
+
+#endif // FRAME_POLICY
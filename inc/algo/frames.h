@@ -2,7 +2,10 @@
 #define FRAMES
 
 #include "_logging.h"
+#include "artifacts.h"
+#include "frame-policy.h"
 #include "frame.h"
+#include "lit.h"
 #include "logger.h"
 #include "pdr-model.h"
 #include "solver.h"
@@ -12,6 +15,7 @@
 #include <cstddef>
 #include <fmt/format.h>
 #include <memory>
+#include <ostream>
 #include <set>
 #include <vector>
 #include <z3++.h>
@@ -19,24 +23,73 @@
 namespace pdr
 {
     using CubeSet = std::set<z3::expr_vector, z3ext::expr_vector_less>;
-    using Witness = std::unique_ptr<z3::model>;
 
-    class Frames
+    // the blocked cubes and the solver lemmas at one point, in a context of
+    // their own so they can be written on the artifact thread
+    struct FramesSnapshot
+    {
+        // cubes per frame, the last is F_inf
+        std::vector<std::vector<unsigned>> cube_sizes;
+        // 0: the literals of every cube, then the lemmas of every solver
+        std::unique_ptr<ExprSnapshot> exprs;
+
+        // the "Frames" and "Solvers" sections of the solver dump
+        void show(std::ostream& out) const;
+    };
+
+    template <typename Policy> class Frames
     {
       private:
-        bool delta;
         z3::context& ctx;
         const PDRModel& model;
         Logger& logger;
         std::vector<z3::expr_vector> base_assertions;
-        std::unique_ptr<Solver> delta_solver;
         std::vector<std::unique_ptr<Frame>> frames;
-        std::vector<z3::expr> act;
+        Policy encoding;
+        // F_inf: cubes that are blocked in every reachable state
+        CubeSet inf_cubes;
+        // the clauses of F_inf. shared by the base_assertions of every solver
+        z3::expr_vector inf_clauses;
+        // T & cardinality & F_inf, to verify lemmas for F_inf
+        std::unique_ptr<Solver> inf_solver;
+        // I, to check cubes against the initial states
+        std::unique_ptr<Solver> init_solver;
+        // frontier lemmas that promote_to_inf already checked this run
+        CubeSet inf_tried;
+        // reused assumptions for queries over integer literals
+        mutable std::vector<Z3_ast> assumption_buffer;
+        // z3ext::vectors_built at the end of the last query
+        mutable unsigned long vectors_mark = 0;
 
-      public:
-        z3::solver init_solver;
+        bool SAT_buffer(size_t frame, Query q) const;
+        bool init_SAT_buffer(Query q) const;
+        void count_vectors() const;
+
+        // encoding specific, see frame-policy.h
+        //
+        void init_encoding();
+        // provide base_assertions to the solvers of F_1..
+        void set_frame_base();
+        // block cube in F_1..F_level
+        bool block_in_frames(const z3::expr_vector& cube, size_t level);
+        // pushes the cubes of F_level to F_level+1. returns level if this
+        // shows F_level == F_level+1, else -1
+        int push_forward(unsigned level, bool repeat);
+        // the first F_i, i <= level, that is equal to F_i+1 after
+        // propagation. -1 if there is none
+        int converged(unsigned level) const;
+        // adds clause to the solvers of F_1..
+        void add_to_frames(const z3::expr& clause);
+        Solver* frame_solver(size_t frame) const;
+        // appends the assumptions that select F_frame to assumption_buffer
+        void activate(size_t frame) const;
+        // adds the statistics of the solvers of the encoding to s
+        void encoding_statistics(Statistics& s) const;
+        // the lemmas of every solver of the encoding
+        std::vector<z3::expr_vector> solver_lemmas() const;
 
-        Frames(bool d, z3::context& c, const PDRModel& m, Logger& l);
+      public:
+        Frames(z3::context& c, const PDRModel& m, Logger& l);
 
         // frame interface
         //
@@ -45,40 +98,47 @@ namespace pdr
                           const std::vector<z3::expr_vector>& assertions);
 		void clean_solvers();
         bool remove_state(const z3::expr_vector& cube, size_t level);
-        bool delta_remove_state(const z3::expr_vector& cube, size_t level);
-        bool fat_remove_state(const z3::expr_vector& cube, size_t level);
         int propagate(unsigned level, bool repeat = false);
-        void push_forward_delta(unsigned level, bool repeat = false);
-        int push_forward_fat(unsigned level, bool repeat = false);
 
-        // queries
+        // F_inf interface
+        //
+        // returns if the negation of cube is inductive relative to F_inf
+        bool inf_inductive(const z3::expr_vector& cube, Query q) const;
+        // adds !cube to F_inf and every solver.
+        // returns false if it was already present
+        bool block_inf(const z3::expr_vector& cube);
+        // moves the lemmas in the frontier that are inductive relative to
+        // F_inf into F_inf. only checks lemmas that were not yet tried in
+        // this run. returns the number of moved lemmas
+        unsigned promote_to_inf();
+        const CubeSet& get_inf() const;
+
+        // queries. q is the kind of query, for the latency statistics
         //
-        bool init_implies(const z3::expr_vector& formula) const;
+        // returns if cube has a state in I
+        bool init_intersects(const z3::expr_vector& cube, Query q) const;
         // returns if the negation of cube is inductive relative to F_frame
-        bool inductive(const std::vector<z3::expr>& cube, size_t frame) const;
-        bool inductive(const z3::expr_vector& cube, size_t frame) const;
-        Witness counter_to_inductiveness(const std::vector<z3::expr>& cube,
-                                         size_t frame) const;
-        Witness counter_to_inductiveness(const z3::expr_vector& cube,
-                                         size_t frame) const;
+        bool inductive(const z3::expr_vector& cube, size_t frame,
+                       Query q) const;
         // returns if there exists a transition from frame to cube,
         // allows collection of witness from solver(frame) if true.
-        bool trans_from_to(size_t frame, const z3::expr_vector& cube,
+        bool trans_from_to(size_t frame, const z3::expr_vector& cube, Query q,
                            bool primed = false) const;
-        std::unique_ptr<z3::model>
-            get_trans_from_to(size_t frame, const z3::expr_vector& cube,
-                              bool primed = false) const;
+        // integer literal queries. only builds the clause !cube, the
+        // literals come from the table of the model
+        bool inductive(LitSpan cube, size_t frame, Query q) const;
+        bool trans_from_to(size_t frame, LitSpan cube, Query q) const;
+        bool init_intersects(LitSpan cube, Query q) const;
 
         // Solver calls
         //
         // returns if there exists a satisfying assignment
-        bool SAT(size_t frame, const z3::expr_vector& assumptions) const;
-        bool SAT(size_t frame, z3::expr_vector&& assumptions) const;
-        // returns a satisfying assignment if it exists
-        Witness SAT_model(size_t frame,
-                          const z3::expr_vector& assumptions) const;
-        Witness SAT_model(size_t frame, z3::expr_vector&& assumptions) const;
+        bool SAT(size_t frame, const z3::expr_vector& assumptions,
+                 Query q) const;
         const z3::model get_model(size_t frame) const;
+        // the current state in the model of the last SAT call on frame, sorted
+        // by literal. valid until the next witness of the same solver
+        LitSpan witness_current(size_t frame) const;
         void reset_solver(size_t frame);
 
         // getters
@@ -87,11 +147,66 @@ namespace pdr
         Solver* solver(size_t frame);
         const Frame& operator[](size_t i);
 
-        void log_solvers() const;
-        std::string blocked_str() const;
-        std::string solvers_str() const;
+        // stores the z3 statistics of every solver and the lemmas per frame
+        // in s
+        void solver_statistics(Statistics& s) const;
+        // writes the cubes of every frame and F_inf as integer literals, one
+        // cube per line:
+        //   # pdr frames <number of variables>
+        //   frame <i>
+        //   <lit> <lit> ...
+        //   inf
+        //   <lit> <lit> ...
+        // read by cube-bench
+        void dump(std::ostream& out) const;
+        // records the cubes of every frame as trace events
+        void trace_lemmas() const;
+        std::shared_ptr<const FramesSnapshot> snapshot() const;
     };
 
+    // fat encoding, frames-fat.cpp
+    template <> void Frames<FatPolicy>::init_encoding();
+    template <> void Frames<FatPolicy>::extend();
+    template <> void Frames<FatPolicy>::set_frame_base();
+    template <> void Frames<FatPolicy>::clean_solvers();
+    template <>
+    bool Frames<FatPolicy>::block_in_frames(const z3::expr_vector& cube,
+                                            size_t level);
+    template <>
+    int Frames<FatPolicy>::push_forward(unsigned level, bool repeat);
+    template <> int Frames<FatPolicy>::converged(unsigned level) const;
+    template <>
+    void Frames<FatPolicy>::add_to_frames(const z3::expr& clause);
+    template <> Solver* Frames<FatPolicy>::frame_solver(size_t frame) const;
+    template <> void Frames<FatPolicy>::activate(size_t frame) const;
+    template <>
+    void Frames<FatPolicy>::encoding_statistics(Statistics& s) const;
+    template <>
+    std::vector<z3::expr_vector> Frames<FatPolicy>::solver_lemmas() const;
+
+    // delta encoding, frames-delta.cpp
+    template <> void Frames<DeltaPolicy>::init_encoding();
+    template <> void Frames<DeltaPolicy>::extend();
+    template <> void Frames<DeltaPolicy>::set_frame_base();
+    template <> void Frames<DeltaPolicy>::clean_solvers();
+    template <>
+    bool Frames<DeltaPolicy>::block_in_frames(const z3::expr_vector& cube,
+                                              size_t level);
+    template <>
+    int Frames<DeltaPolicy>::push_forward(unsigned level, bool repeat);
+    template <> int Frames<DeltaPolicy>::converged(unsigned level) const;
+    template <>
+    void Frames<DeltaPolicy>::add_to_frames(const z3::expr& clause);
+    template <>
+    Solver* Frames<DeltaPolicy>::frame_solver(size_t frame) const;
+    template <> void Frames<DeltaPolicy>::activate(size_t frame) const;
+    template <>
+    void Frames<DeltaPolicy>::encoding_statistics(Statistics& s) const;
+    template <>
+    std::vector<z3::expr_vector> Frames<DeltaPolicy>::solver_lemmas() const;
+
+    extern template class Frames<FatPolicy>;
+    extern template class Frames<DeltaPolicy>;
 } // namespace pdr
 
 #endif // FRAMES
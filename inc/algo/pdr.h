@@ -4,7 +4,9 @@
 #include "_logging.h"
 #include "frames.h"
 #include "pdr-model.h"
+#include "reachable.h"
 #include "result.h"
+#include "simulation.h"
 #include "stats.h"
 #include "z3-ext.h"
 
@@ -22,29 +24,38 @@
 
 namespace pdr
 {
-  class PDR
+  // Policy: the encoding of the frames, see frame-policy.h
+  template <typename Policy> class PDR
   {
    private:
     z3::context& ctx;
     PDRModel& model;
-    bool delta; // use a delta encoding for the frames
 
     spdlog::stopwatch timer;
     spdlog::stopwatch sub_timer;
     Logger& logger;
 
     unsigned k = 0;
-    Frames frames;
+    Frames<Policy> frames;
+    // states of earlier counterexamples, survives decrement
+    ReachableStates reachable;
 
     PDResults& results;
     int shortest_strategy;
 
     // if mic fails to reduce a clause c this many times, take c
     const unsigned mic_retries = 3;
+    // maximum number of structural invariants to mine
+    const unsigned mine_limit = 1000;
+    // reachable states sampled by random walks, to reject generalizations
+    const unsigned sim_words = 4; // 64 walks per word
+    const unsigned sim_steps = 128;
+    Simulation simulation;
 
     void print_model(const z3::model& m);
     // main loops
     bool init();
+    void fast_forward_frames();
     bool iterate();
     bool iterate_short();
     bool block(z3::expr_vector& counter, unsigned o_level, unsigned level);
@@ -56,13 +67,15 @@ namespace pdr
                                 z3::expr_vector& core);
     z3::expr_vector generalize(const z3::expr_vector& cube, int level);
     z3::expr_vector MIC(const z3::expr_vector& cube, int level);
-    bool down(std::vector<z3::expr>& cube, int level);
+    bool down(Cube& cube, int level);
+    // invariant mining
+    std::vector<std::vector<int>> invariant_candidates() const;
+    unsigned mine_invariants();
     // results
     void store_result();
     void show_trace(const std::shared_ptr<State> trace_root,
                     std::ostream& out) const;
     bool finish(bool);
-    void store_frame_strings();
 
     void log_and_show(const std::string& str) const;
     void log_start() const;
@@ -74,18 +87,29 @@ namespace pdr
     void log_pred(const z3::expr_vector& p);
     void log_state_push(unsigned frame, const z3::expr_vector& p);
     void log_finish(const z3::expr_vector& s);
-    void log_obligation(const std::string& type, unsigned l, double time);
+    void log_obligation(trace::Event type, unsigned l, double time);
+    // hand a Snapshot to the logger's monitor if one is due
+    void publish_progress(size_t queue_size);
 
    public:
     // bool dynamic_cardinality = true;
     bool dynamic_cardinality   = false;
-    std::string frames_string  = "";
-    std::string solvers_string = "";
+    bool mine                  = false; // mine structural invariants
+    bool fast_forward          = false; // skip levels below the dag depth
+    // take a FramesSnapshot at every finish, for show_solver
+    bool snapshot_frames = false;
+    // the frames and solvers at the last finish, if snapshot_frames
+    std::shared_ptr<const FramesSnapshot> frames_snapshot;
 
-    PDR(PDRModel& m, bool d, Logger& l, PDResults& r);
+    PDR(PDRModel& m, Logger& l, PDResults& r);
     void reset();
     bool run(bool optimize = false);
-    void show_solver(std::ostream& out, unsigned it) const;
+    // writes the frames and solvers of snapshot, or None. does not touch the
+    // algorithm, so it can run on the artifact thread
+    static void show_solver(std::ostream& out, unsigned it,
+                            const FramesSnapshot* snapshot);
+    // the cubes of the frames in the format of Frames::dump
+    void dump_frames(std::ostream& out) const;
     void show_results(std::ostream& out) const;
 
     // reduces the max pebbles of the model to 1 lower than the previous
@@ -96,5 +120,8 @@ namespace pdr
     Statistics& stats();
     int length_shortest_strategy() const;
   };
+
+  extern template class PDR<FatPolicy>;
+  extern template class PDR<DeltaPolicy>;
 } // namespace pdr
 #endif // PDR_ALG
@@ -0,0 +1,62 @@
+#ifndef PDR_REACHABLE_H
+#define PDR_REACHABLE_H
+
+#include "obligation.h"
+#include "pdr-model.h"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+#include <z3++.h>
+
+namespace pdr
+{
+  // states that are known to be reachable from I, found through earlier
+  // counterexamples. every state is stored in full, as the set of pebbled
+  // nodes, together with the state it was reached from
+  class ReachableStates
+  {
+   public:
+    using Bits = std::vector<uint64_t>;
+
+    struct Entry
+    {
+      Bits pebbled;
+      z3::expr_vector cube; // the full state as a cube of current literals
+      unsigned depth;       // number of steps from I
+      int parent;           // index of the previous state, -1 if I
+      int pebbles;
+    };
+
+    ReachableStates(z3::context& c, const PDRModel& m);
+
+    // concretizes the trace I -> root -> root.prev ... and stores its states,
+    // up to the first cube that has no concrete successor of the previous
+    // state. returns the number of new states
+    unsigned add_trace(const std::shared_ptr<State>& root);
+    // index of a state that lies in cube and is reached within max_depth
+    // steps. -1 if there is none
+    int find(const z3::expr_vector& cube, unsigned max_depth) const;
+    // the trace I -> ... -> entry i -> next, with next being the remainder of
+    // a counterexample that starts in entry i
+    std::shared_ptr<State> trace(int i, std::shared_ptr<State> next) const;
+    // forget states that are only reached by exceeding the current
+    // cardinality of the model. called after the cardinality is lowered
+    void restrict();
+
+    size_t size() const;
+
+   private:
+    const PDRModel& model;
+    size_t words;
+    std::vector<Entry> entries;
+    std::map<Bits, int> index; // pebbled nodes -> entry
+    // T & cardinality, to find a concrete successor in a cube
+    z3::solver step_solver;
+
+    void reset_solver();
+    int insert(Bits&& pebbled, z3::expr_vector&& cube, int parent);
+  };
+} // namespace pdr
+#endif // PDR_REACHABLE_H
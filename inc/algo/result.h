@@ -18,18 +18,20 @@ namespace pdr
     unsigned trace_length;
     int pebbles_used;
     int invariant_index;
+    unsigned inf_lemmas; // size of F_inf at the end of the run
     double total_time;
 
     PDResult()
         : trace(nullptr), trace_string(""), trace_length(0), pebbles_used(-1),
-          invariant_index(-1), total_time(0.0)
+          invariant_index(-1), inf_lemmas(0), total_time(0.0)
     {
     }
 
     std::vector<std::string> listing() const
     {
       return {std::to_string(pebbles_used), std::to_string(invariant_index),
-              std::to_string(trace_length), std::to_string(total_time)};
+              std::to_string(trace_length), std::to_string(inf_lemmas),
+              std::to_string(total_time)};
     }
   };
 
@@ -50,13 +52,18 @@ namespace pdr
       t.setAlignment(1, TextTable::Alignment::RIGHT);
       t.setAlignment(2, TextTable::Alignment::RIGHT);
       t.setAlignment(3, TextTable::Alignment::RIGHT);
+      t.setAlignment(4, TextTable::Alignment::RIGHT);
 
       out << fmt::format("Pebbling strategies for {}:", model.name) << std::endl
+          << fmt::format("Structural lower bound: {}",
+                         model.get_lower_bound().str())
+          << std::endl
           << std::endl;
       out << SEP2 << std::endl;
 
       std::vector<std::string> header = {"pebbles", "invariant index",
-                                         "strategy length", "Total time"};
+                                         "strategy length", "F_inf lemmas",
+                                         "Total time"};
       t.addRow(header);
       for (const PDResult& res : vec)
         t.addRow(res.listing());
@@ -0,0 +1,44 @@
+#ifndef PDR_SIMULATION_H
+#define PDR_SIMULATION_H
+
+#include "lit.h"
+#include "pdr-model.h"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+#include <z3++.h>
+
+namespace pdr
+{
+  // random walks of the pebbling game from I, 64 walks per machine word.
+  // every step is a legal (parallel) transition under the cardinality of the
+  // model, so each snapshot holds states that are reachable within that
+  // number of steps
+  class Simulation
+  {
+   public:
+    Simulation(const PDRModel& m, unsigned n_words, unsigned n_steps);
+
+    // (re)run all walks from I under the current cardinality
+    void run();
+    // returns true if a sampled state that is reached within max_steps lies
+    // in cube
+    bool intersects(LitSpan cube, unsigned max_steps) const;
+
+   private:
+    using Words = std::vector<uint64_t>; // node * words + w
+
+    const PDRModel& model;
+    const unsigned words;
+    const unsigned steps;
+    std::mt19937_64 rng;
+    // snapshots[i]: the states of all walks after i + 1 steps
+    std::vector<Words> snapshots;
+
+    Words step(const Words& current);
+    // a mask of the walks in which more than k nodes are pebbled
+    Words exceeds(const Words& state, int k) const;
+  };
+} // namespace pdr
+#endif // PDR_SIMULATION_H
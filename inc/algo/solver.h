@@ -1,5 +1,8 @@
 #ifndef SOLVER_H
 #define SOLVER_H
+#include "lit.h"
+#include "query-log.h"
+#include "stats.h"
 #include "z3-ext.h"
 
 #include <fmt/core.h>
@@ -21,10 +24,19 @@ namespace pdr
     bool core_available = false;
     unsigned cubes_start; // point where base_assertions ends and other
                           // assertions begin
+    Cube witness_buffer;
+    // z3 statistics of the internal solver before its last reset
+    SolverStats retired;
+    // records every operation if set, as solver log_id
+    queries::QueryLog* log;
+    uint32_t log_id = 0;
+
+    void set(const char* key, bool value);
 
   public:
     std::vector<z3::expr_vector> base_assertions;
-    Solver(z3::context& c, std::vector<z3::expr_vector> base);
+    Solver(z3::context& c, std::vector<z3::expr_vector> base,
+           queries::QueryLog* l = nullptr);
 
     void init();
     void reset();
@@ -34,18 +46,18 @@ namespace pdr
     void add(const z3::expr& e);
 
     bool SAT(const z3::expr_vector& assumptions);
+    // assumptions are owned by the caller, eg. the literal table of the model
+    bool SAT(const Z3_ast* assumptions, unsigned n);
     z3::model get_model() const;
+    // the assignment to vars in the model of the last SAT call, as literals
+    // over the indices of vars. unassigned vars are skipped, the result is
+    // sorted. valid until the next call
+    LitSpan witness(const std::vector<z3::expr>& vars);
     std::string as_str(const std::string& header = "") const;
-
-    // function to extract a cube representing a satisfying assignment to
-    // the last SAT call to the solver. the resulting vector or expr_vector
-    // is in sorted order template UnaryPredicate: function expr->bool to
-    // filter atoms. accepts 1 expr, returns bool
-    template <typename UnaryPredicate>
-    static z3::expr_vector filter_witness(const z3::model& m, UnaryPredicate p);
-    template <typename UnaryPredicate>
-    static std::vector<z3::expr> filter_witness_vector(const z3::model& m,
-                                                       UnaryPredicate p);
+    // the assertions after the base assertions
+    z3::expr_vector lemmas() const;
+    // the z3 statistics of all queries since construction
+    SolverStats statistics() const;
 
     // function extract the unsat_core from the solver, a subset of the
     // assumptions the resulting vector or expr_vector is in sorted order
@@ -58,41 +70,6 @@ namespace pdr
     z3::expr_vector unsat_core(UnaryPredicate p, Transform t);
   };
 
-  template <typename UnaryPredicate>
-  z3::expr_vector Solver::filter_witness(const z3::model& m, UnaryPredicate p)
-  {
-    std::vector<z3::expr> std_vec = filter_witness_vector(m, p);
-    z3::expr_vector v(std_vec[0].ctx());
-    for (const z3::expr& e : std_vec)
-      v.push_back(e);
-    return v;
-  }
-
-  template <typename UnaryPredicate>
-  std::vector<z3::expr> Solver::filter_witness_vector(const z3::model& m,
-                                                      UnaryPredicate p)
-  {
-    std::vector<z3::expr> v;
-    v.reserve(m.num_consts());
-    for (unsigned i = 0; i < m.size(); i++)
-    {
-      z3::func_decl f = m[i];
-      z3::expr b_value = m.get_const_interp(f);
-      z3::expr literal = f();
-      if (p(literal))
-      {
-        if (b_value.is_true())
-          v.push_back(literal);
-        else if (b_value.is_false())
-          v.push_back(!literal);
-        else
-          throw std::runtime_error("model contains non-constant");
-      }
-    }
-    std::sort(v.begin(), v.end(), z3ext::expr_less());
-    return v;
-  }
-
   template <typename UnaryPredicate, typename Transform>
   z3::expr_vector Solver::unsat_core(UnaryPredicate p, Transform t)
   {
@@ -0,0 +1,155 @@
+#ifndef PDR_LIT_H
+#define PDR_LIT_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "z3-ext.h"
+
+namespace pdr
+{
+  // AIGER-style literal: 2 * var + sign, with var the index of a node in the
+  // literal ExpressionCache of the model. sign 1 means negated (unpebbled)
+  using Lit = uint32_t;
+
+  inline Lit mk_lit(unsigned var, bool negated = false)
+  {
+    return 2 * var + negated;
+  }
+  inline unsigned lit_var(Lit l) { return l >> 1; }
+  inline bool lit_sign(Lit l) { return l & 1; }
+  inline Lit lit_neg(Lit l) { return l ^ 1; }
+
+  // vector with inline storage for the first N elements, for trivially
+  // copyable T. only spills to the heap for larger sizes
+  template <typename T, size_t N> class SmallVector
+  {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "SmallVector stores elements by memcpy");
+
+   private:
+    T buffer[N];
+    std::unique_ptr<T[]> heap;
+    T* elements     = buffer;
+    size_t n        = 0;
+    size_t capacity = N;
+
+    void grow(size_t min_capacity)
+    {
+      size_t new_capacity = std::max(2 * capacity, min_capacity);
+      std::unique_ptr<T[]> new_heap(new T[new_capacity]);
+      std::memcpy(new_heap.get(), elements, n * sizeof(T));
+      heap     = std::move(new_heap);
+      elements = heap.get();
+      capacity = new_capacity;
+      z3ext::vectors_built++;
+    }
+
+   public:
+    SmallVector() = default;
+    SmallVector(const T* first, const T* last) { assign(first, last); }
+    SmallVector(const SmallVector& other) { assign(other.begin(), other.end()); }
+    SmallVector& operator=(const SmallVector& other)
+    {
+      if (this != &other)
+        assign(other.begin(), other.end());
+      return *this;
+    }
+    SmallVector(SmallVector&& other) { *this = std::move(other); }
+    SmallVector& operator=(SmallVector&& other)
+    {
+      if (this == &other)
+        return *this;
+      if (other.heap) // steal the heap storage
+      {
+        heap     = std::move(other.heap);
+        elements = heap.get();
+        capacity = other.capacity;
+        n        = other.n;
+      }
+      else
+        assign(other.begin(), other.end());
+
+      other.elements = other.buffer;
+      other.capacity = N;
+      other.n        = 0;
+      return *this;
+    }
+
+    void assign(const T* first, const T* last)
+    {
+      size_t size = last - first;
+      n           = 0;
+      reserve(size);
+      std::memcpy(elements, first, size * sizeof(T));
+      n = size;
+    }
+    void reserve(size_t size)
+    {
+      if (size > capacity)
+        grow(size);
+    }
+    void push_back(const T& x)
+    {
+      if (n == capacity)
+        grow(n + 1);
+      elements[n++] = x;
+    }
+    void pop_back() { n--; }
+    void clear() { n = 0; }
+    // removes the element at i, keeping the order
+    void erase(size_t i)
+    {
+      assert(i < n);
+      std::memmove(elements + i, elements + i + 1, (n - i - 1) * sizeof(T));
+      n--;
+    }
+
+    size_t size() const { return n; }
+    bool empty() const { return n == 0; }
+    T* data() { return elements; }
+    const T* data() const { return elements; }
+    T* begin() { return elements; }
+    T* end() { return elements + n; }
+    const T* begin() const { return elements; }
+    const T* end() const { return elements + n; }
+    T& operator[](size_t i) { return elements[i]; }
+    const T& operator[](size_t i) const { return elements[i]; }
+
+    bool operator==(const SmallVector& other) const
+    {
+      return n == other.n && std::equal(begin(), end(), other.begin());
+    }
+  };
+
+  // a cube of literals
+  using Cube = SmallVector<Lit, 16>;
+
+  // non-owning view of a sequence of literals
+  struct LitSpan
+  {
+    const Lit* first = nullptr;
+    size_t n         = 0;
+
+    LitSpan() = default;
+    LitSpan(const Lit* f, size_t size) : first(f), n(size) {}
+    template <size_t N>
+    LitSpan(const SmallVector<Lit, N>& v) : first(v.data()), n(v.size())
+    {
+    }
+    LitSpan(const std::vector<Lit>& v) : first(v.data()), n(v.size()) {}
+
+    size_t size() const { return n; }
+    bool empty() const { return n == 0; }
+    const Lit* begin() const { return first; }
+    const Lit* end() const { return first + n; }
+    Lit operator[](size_t i) const { return first[i]; }
+  };
+} // namespace pdr
+#endif // PDR_LIT_H
@@ -13,6 +13,12 @@ namespace z3ext
   using z3::expr;
   using z3::expr_vector;
 
+  // a call counter, not an allocation count: incremented once by every
+  // helper marked "!allocates" that builds a new expr_vector, and by every
+  // SmallVector that grows onto the heap. what z3 allocates inside these is
+  // not counted. sampled per solver query in the statistics
+  inline unsigned long vectors_built = 0;
+
   inline expr minus(const expr& e) { return e.is_not() ? e.arg(0) : !e; }
 
   // !allocates new vector
@@ -22,6 +28,7 @@ namespace z3ext
   inline expr_vector copy(const expr_vector& v)
   {
     z3::expr_vector new_v(v.ctx());
+    vectors_built++;
     for (const z3::expr& e : v)
       new_v.push_back(e);
 
@@ -32,6 +39,7 @@ namespace z3ext
   inline expr_vector negate(const expr_vector& lits)
   {
     expr_vector negated(lits.ctx());
+    vectors_built++;
     for (const expr& e : lits)
       negated.push_back(minus(e));
     return negated;
@@ -41,6 +49,7 @@ namespace z3ext
   inline expr_vector negate(const vector<expr>& lits)
   {
     expr_vector negated(lits[0].ctx());
+    vectors_built++;
     for (const expr& e : lits)
       negated.push_back(minus(e));
     return negated;
@@ -51,6 +60,7 @@ namespace z3ext
   {
     assert(vec.size() > 0);
     expr_vector converted(vec[0].ctx());
+    vectors_built++;
     for (const expr& e : vec)
       converted.push_back(std::move(e));
     return converted;
@@ -61,6 +71,7 @@ namespace z3ext
   {
     assert(vec.size() > 0);
     expr_vector converted(vec[0].ctx());
+    vectors_built++;
     for (const expr& e : vec)
       converted.push_back(std::move(e));
     return converted;
@@ -79,6 +90,7 @@ namespace z3ext
   inline expr_vector args(const expr& e)
   {
     expr_vector vec(e.ctx());
+    vectors_built++;
     for (unsigned i = 0; i < e.num_args(); i++)
       vec.push_back(e.arg(i));
     return vec;
@@ -5,66 +5,76 @@
 #include "string-ext.h"
 
 #include <cassert>
+#include <cstdint>
 #include <fmt/format.h>
 #include <ghc/filesystem.hpp>
 #include <graphviz/gvc.h>
-#include <map>
-#include <set>
-#include <sstream>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace dag
 {
-  struct Edge
-  {
-    std::string from;
-    std::string to;
-
-    Edge(const std::string& f, const std::string& t) : from(f), to(t) {}
+  // index of a vertex. nodes are 0..size()-1 in order of name, inputs that
+  // are not nodes follow in order of name
+  using Node = int;
 
-    friend bool operator<(const Edge& lhs, const Edge& rhs)
-    {
-      if (lhs.from < rhs.from)
-        return true;
-      if (rhs.from < lhs.from)
-        return false;
-
-      if (lhs.to < rhs.to)
-        return true;
-      return false;
-    }
+  // a contiguous range of vertices in a Graph
+  class Nodes
+  {
+   private:
+    const Node* first;
+    const Node* last;
 
-    friend std::stringstream& operator<<(std::stringstream& stream,
-                                         Edge const& e)
-    {
-      stream << "(" << e.from << ", " << e.to << ")";
-      return stream;
-    }
+   public:
+    Nodes(const Node* f, const Node* l) : first(f), last(l) {}
+    const Node* begin() const { return first; }
+    const Node* end() const { return last; }
+    size_t size() const { return last - first; }
+    bool empty() const { return first == last; }
+    Node operator[](size_t i) const { return first[i]; }
   };
 
+  // the nodes, inputs and edges of a circuit. built by name with add_input,
+  // add_node, add_output and add_edges_to, then numbered by finish(). the
+  // children and parents of the nodes are then kept as CSR arrays: the
+  // neighbours of v are ids[offsets[v]..offsets[v + 1]]
   class Graph
   {
    private:
-    std::map<std::string, std::vector<std::string>> children; // nodes X nodes
-    std::set<Edge> input_edges;                               // nodes X nodes
-    std::vector<std::string> empty_vec;
+    enum Flag : uint8_t
+    {
+      input_flag  = 1,
+      node_flag   = 2,
+      output_flag = 4
+    };
+
+    std::vector<std::string> names;             // id -> name
+    std::unordered_map<std::string, Node> ids;  // name -> id
+    std::vector<uint8_t> flags;                 // id -> Flag
+    std::vector<std::pair<Node, Node>> added;   // (to, from), until finish()
+    bool finished = false;
+
+    size_t n_nodes = 0, n_inputs = 0;
+    std::vector<Node> outputs;                  // sorted
+    std::vector<uint32_t> child_offsets, parent_offsets;
+    std::vector<Node> child_ids, parent_ids;    // between nodes
+    std::vector<std::pair<Node, Node>> input_edges; // input X nodes
+
     std::unique_ptr<graphviz::Graph> image;
 
+    Node vertex(const std::string& name);
+
    public:
     std::string name;
     std::string prefix = "";
 
-    std::set<std::string> input;
-    std::set<std::string> nodes;
-    std::set<std::string> output; // subet of nodes
-    std::set<Edge> edges;         // nodes X nodes
-
     std::string node(std::string name) { return prefix + name; }
 
     Graph();
     Graph(const std::string& s);
-    Graph(const std::string& s, const std::string& dot);
 
     void add_input(std::string iname);
 
@@ -74,17 +84,43 @@ namespace dag
 
     void add_edges_to(std::vector<std::string> from, std::string to);
 
+    // number the vertices and build the CSR arrays. no vertices or edges can
+    // be added after
+    void finish();
+
+    // number of nodes, inputs are not counted
+    size_t size() const { return n_nodes; }
+    size_t input_size() const { return n_inputs; }
+    size_t output_size() const { return outputs.size(); }
+    // edges between nodes
+    size_t edge_size() const { return child_ids.size(); }
+
+    const std::string& name_of(Node v) const { return names.at(v); }
+    // the id of a vertex by name, -1 if there is none
+    Node find(const std::string& name) const;
+    bool is_output(Node v) const { return flags[v] & output_flag; }
+    const std::vector<Node>& get_outputs() const { return outputs; }
+
+    // children and parents within the nodes, without inputs
+    Nodes get_children(Node v) const
+    {
+      return { child_ids.data() + child_offsets[v],
+               child_ids.data() + child_offsets[v + 1] };
+    }
+    Nodes get_parents(Node v) const
+    {
+      return { parent_ids.data() + parent_offsets[v],
+               parent_ids.data() + parent_offsets[v + 1] };
+    }
+
     std::string summary() const;
 
     friend std::ostream& operator<<(std::ostream& stream, Graph const& g);
 
+    // lays out the graph with graphviz and renders it to destination.svg
     void show_image(const std::string& destination);
 
     std::string dot();
-
-    bool is_output(const std::string& name) const;
-
-    const std::vector<std::string>& get_children(const std::string& key) const;
   };
 } // namespace dag
 
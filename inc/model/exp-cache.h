@@ -2,13 +2,15 @@
 #define EXP_CACHE
 
 #include <cassert>
+#include <cstdint>
 #include <memory>
 #include <ostream>
+#include <stdexcept>
 #include <string>
-#include <unordered_map>
 #include <vector>
 #include <z3++.h>
 
+#include "lit.h"
 #include "string-ext.h"
 #include "z3-ext.h"
 
@@ -24,11 +26,42 @@ class ExpressionCache
         EXPRESSIONS
     } encodes;
     z3::context& ctx;
-    std::unordered_map<unsigned, int> literal_index;
-    std::unordered_map<unsigned, int> literal_index_p;
+    // dense lookup tables, indexed by ast id: the literal an expression
+    // encodes in the current or next state, no_lit if it is none. atoms are
+    // added by add_literal(), their negations by finish()
+    static constexpr pdr::Lit no_lit = UINT32_MAX;
+    std::vector<pdr::Lit> id_lit;
+    std::vector<pdr::Lit> id_lit_p;
 
     z3::expr_vector current;
     z3::expr_vector next;
+    // literal tables, indexed by pdr::Lit. built by finish()
+    std::vector<z3::expr> lit_current;
+    std::vector<z3::expr> lit_next;
+    // the atoms of the current state, indexed by variable
+    std::vector<z3::expr> var_current;
+
+    static void set_lit(std::vector<pdr::Lit>& table, const z3::expr& e,
+                        pdr::Lit l)
+    {
+        unsigned id = e.id();
+        if (id >= table.size())
+            table.resize(id + 1, no_lit);
+        table[id] = l;
+    }
+    static pdr::Lit get_lit(const std::vector<pdr::Lit>& table,
+                            const z3::expr& e)
+    {
+        unsigned id = e.id();
+        return id < table.size() ? table[id] : no_lit;
+    }
+    static pdr::Lit at(const std::vector<pdr::Lit>& table, const z3::expr& e)
+    {
+        pdr::Lit l = get_lit(table, e);
+        if (l == no_lit)
+            throw std::out_of_range("not a literal: " + e.to_string());
+        return l;
+    }
 
   public:
     ExpressionCache(z3::context& c)
@@ -36,42 +69,35 @@ class ExpressionCache
     {
     }
 
-    int indexof(const z3::expr& e) const { return literal_index.at(e.id()); }
+    int indexof(const z3::expr& e) const
+    {
+        pdr::Lit l = at(id_lit, e);
+        assert(!pdr::lit_sign(l));
+        return pdr::lit_var(l);
+    }
     // checks if e is an atom in current. fails if e is not an atom (const)
     bool atom_is_current(const z3::expr& e) const
     {
         assert(e.is_const());
-        return literal_index.find(e.id()) != literal_index.end();
+        pdr::Lit l = get_lit(id_lit, e);
+        return l != no_lit && !pdr::lit_sign(l);
     }
     // returns true if e is a literal in current. else false
     bool literal_is_current(const z3::expr& e) const
     {
-        if (e.is_not())
-            return literal_index.find(e.arg(0).id()) != literal_index.end();
-        return atom_is_current(e);
+        return get_lit(id_lit, e) != no_lit;
     }
 
     bool literal_is_p(const z3::expr& e) const
     {
-        if (e.is_not())
-            return literal_index_p.find(e.arg(0).id()) != literal_index.end();
-        if (e.is_const())
-            return literal_index_p.find(e.id()) != literal_index.end();
-        return false;
+        return get_lit(id_lit_p, e) != no_lit;
     }
 
     // converts a literal in the next state to a literal in the current state
     z3::expr operator()(const z3::expr& e) const
     {
-        int index;
-        if (e.is_not())
-        {
-            index = literal_index_p.at(e.arg(0).id());
-            return !current[index];
-        }
-        assert(e.is_const());
-        index = literal_index_p.at(e.id());
-        return current[index];
+        assert(finished);
+        return lit_current[at(id_lit_p, e)];
     }
     z3::expr operator()(int index) const { return current[index]; }
 
@@ -86,15 +112,8 @@ class ExpressionCache
     // next state expressions
     z3::expr p(const z3::expr& e) const
     {
-        if (e.is_not())
-        {
-            int index = literal_index.at(e.arg(0).id());
-            return !next[index];
-        }
-        assert(e.is_const());
-
-        int index = literal_index.at(e.id());
-        return next[index];
+        assert(finished);
+        return lit_next[at(id_lit, e)];
     }
     z3::expr p(int index) const { return next[index]; }
 
@@ -104,6 +123,7 @@ class ExpressionCache
     z3::expr_vector p(const z3::expr_vector& vec) const
     {
         z3::expr_vector vec_next(ctx);
+        z3ext::vectors_built++;
         for (const z3::expr& e : vec)
             vec_next.push_back(p(e));
         return vec_next;
@@ -111,16 +131,43 @@ class ExpressionCache
     z3::expr_vector p(const std::vector<z3::expr>& vec) const
     {
         z3::expr_vector vec_next(ctx);
+        z3ext::vectors_built++;
         for (const z3::expr& e : vec)
             vec_next.push_back(p(e));
         return vec_next;
     }
 
+    // integer literals
+    //
+    // the expression of a literal, in the next state if primed
+    const z3::expr& lit(pdr::Lit l, bool primed = false) const
+    {
+        assert(finished && encodes == Encoding::LITERALS);
+        return primed ? lit_next[l] : lit_current[l];
+    }
+    const std::vector<z3::expr>& vars() const
+    {
+        assert(finished && encodes == Encoding::LITERALS);
+        return var_current;
+    }
+    // the integer literal of a literal in the current state
+    pdr::Lit to_lit(const z3::expr& e) const { return at(id_lit, e); }
+    // the integer literal of a literal in the next state
+    pdr::Lit to_lit_p(const z3::expr& e) const { return at(id_lit_p, e); }
+    // !allocates new vector
+    z3::expr_vector to_expr(pdr::LitSpan cube, bool primed = false) const
+    {
+        z3::expr_vector rv(ctx);
+        z3ext::vectors_built++;
+        for (pdr::Lit l : cube)
+            rv.push_back(lit(l, primed));
+        return rv;
+    }
+
     // expose vectors for enumeration
-    // const expr_vector& are mutable since it only stores a pointer to a
-    // container
-    z3::expr_vector currents() const { return z3ext::copy(current); }
-    z3::expr_vector nexts() const { return z3ext::copy(next); }
+    // a copy of an expr_vector shares its container: copy before modifying
+    const z3::expr_vector& currents() const { return current; }
+    const z3::expr_vector& nexts() const { return next; }
     int size() const { return current.size(); }
 
     void add_literal(const std::string& name)
@@ -132,11 +179,11 @@ class ExpressionCache
         z3::expr lit = ctx.bool_const(name.c_str());
         z3::expr lit_p = ctx.bool_const((name + ".p").c_str());
 
-        current.push_back(std::move(lit));
-        next.push_back(std::move(lit_p));
+        current.push_back(lit);
+        next.push_back(lit_p);
 
-        literal_index.insert(std::make_pair(lit.id(), current.size() - 1));
-        literal_index_p.insert(std::make_pair(lit_p.id(), current.size() - 1));
+        set_lit(id_lit, lit, pdr::mk_lit(current.size() - 1));
+        set_lit(id_lit_p, lit_p, pdr::mk_lit(current.size() - 1));
     }
 
     void add_expression(z3::expr e, const ExpressionCache& cache)
@@ -150,7 +197,36 @@ class ExpressionCache
         next.push_back(e_next);
     }
 
-    void finish() { finished = true; }
+    // as above, with the next state version given instead of substituted
+    void add_expression(z3::expr e, z3::expr e_next)
+    {
+        assert(!finished);
+        encodes = Encoding::EXPRESSIONS;
+
+        current.push_back(e);
+        next.push_back(e_next);
+    }
+
+    void finish()
+    {
+        finished = true;
+        if (encodes != Encoding::LITERALS)
+            return;
+
+        for (const z3::expr& e : current)
+        {
+            var_current.push_back(e);
+            lit_current.push_back(e);
+            lit_current.push_back(!e);
+            set_lit(id_lit, lit_current.back(), lit_current.size() - 1);
+        }
+        for (const z3::expr& e : next)
+        {
+            lit_next.push_back(e);
+            lit_next.push_back(!e);
+            set_lit(id_lit_p, lit_next.back(), lit_next.size() - 1);
+        }
+    }
 
     void show(std::ostream& out) const
     {
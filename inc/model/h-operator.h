@@ -7,7 +7,6 @@
 #include <vector>
 
 #include <mockturtle/algorithms/klut_to_graph.hpp>
-#include <mockturtle/io/write_dot.hpp>
 #include <mockturtle/mockturtle.hpp>
 #include <mockturtle/networks/klut.hpp>
 #include <mockturtle/networks/xmg.hpp>
@@ -16,22 +15,6 @@
 
 using namespace mockturtle;
 
-namespace mockturtle
-{
-  template <class Ntk> class my_dot_drawer : public default_dot_drawer<Ntk>
-  {
-   public:
-    virtual std::string node_label(Ntk const& ntk, node<Ntk> const& n) const
-    {
-      if (ntk.is_pi(n))
-        return "in_" + std::to_string(ntk.node_to_index(n));
-      if (ntk.is_constant(n))
-        return "const_" + std::to_string(ntk.node_to_index(n));
-      return std::to_string(ntk.node_to_index(n));
-    }
-  };
-} // namespace mockturtle
-
 // H-operator as described by https://arxiv.org/pdf/1904.02121.pdf
 inline xmg_network build_hoperator(uint64_t bitwidth, uint64_t modulus)
 {
@@ -76,25 +59,62 @@ inline xmg_network build_hoperator(uint64_t bitwidth, uint64_t modulus)
 
 namespace dag
 {
-  inline Graph from_dot(const xmg_network& network, const std::string& name)
+  // the nodes of network and their fanins, without a graphviz layout.
+  // inputs are "in_<index>", constants "const_<index>" and gates "n_<index>"
+  template <typename Ntk>
+  Graph from_network(const Ntk& network, const std::string& name)
   {
-    std::stringstream dot_string;
-    my_dot_drawer<xmg_network> drawer;
-    write_dot(network, dot_string, drawer);
-
-    return dag::Graph(name, dot_string.str());
+    using Node = typename Ntk::node;
+    auto node_name = [&network](const Node& n)
+    {
+      std::string index = std::to_string(network.node_to_index(n));
+      if (network.is_pi(n))
+        return "in_" + index;
+      if (network.is_constant(n))
+        return "const_" + index;
+      return "n_" + index;
+    };
+
+    Graph G(name);
+    std::vector<std::string> fanins;
+    network.foreach_node(
+        [&](const Node& n)
+        {
+          if (network.is_pi(n))
+          {
+            G.add_input(node_name(n));
+            return;
+          }
+          G.add_node(node_name(n));
+          if (network.is_constant(n))
+            return;
+
+          fanins.clear();
+          network.foreach_fanin(n,
+                                [&](const auto& f)
+                                {
+                                  fanins.push_back(
+                                      node_name(network.get_node(f)));
+                                });
+          G.add_edges_to(fanins, node_name(n));
+        });
+    network.foreach_po([&](const auto& f)
+                       { G.add_output(node_name(network.get_node(f))); });
+    G.finish();
+    return G;
   }
 
-  inline Graph from_dot(const klut_network& network, const std::string& name)
+  inline Graph from_network(const klut_network& network,
+                            const std::string& name)
   {
     xmg_network xmg = convert_klut_to_graph<xmg_network>(network);
-    return from_dot(xmg, name);
+    return from_network(xmg, name);
   }
 
   inline Graph hoperator(uint64_t bitwidth, uint64_t modulus)
   {
     xmg_network h = build_hoperator(bitwidth, modulus);
-    return from_dot(h, fmt::format("hoperator_{}_{}", bitwidth, modulus));
+    return from_network(h, fmt::format("hoperator_{}_{}", bitwidth, modulus));
   }
 
 } // namespace dag
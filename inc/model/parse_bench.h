@@ -171,7 +171,7 @@ namespace parse
 					state = next(state); // try parsing next state
 			}
 			if (state == _END)
-				return G;
+				break;
 
 			add_to_graph(G, result, state);
 
@@ -179,6 +179,7 @@ namespace parse
 		}
 
 		file.close();
+		G.finish();
 		return G;
 	}
 }
@@ -8,6 +8,7 @@
 #include <fstream>
 #include <iterator>
 #include <map>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -108,6 +109,7 @@ namespace parse
         std::string output = node(it);
         G.add_output(output);
       }
+      G.finish();
 
       return G;
     }
@@ -8,6 +8,7 @@
 
 #include "dag.h"
 #include "exp-cache.h"
+#include "pebble-bounds.h"
 
 class PDRModel
 {
@@ -28,13 +29,28 @@ class PDRModel
   const z3::expr_vector& get_cardinality() const;
   int get_max_pebbles() const;
   // sets the new constraint, returns false if final state cannot be pebbled
+  // (x lies below the structural lower bound)
   bool set_max_pebbles(int x);
   int get_f_pebbles() const;
+  const dag::LowerBound& get_lower_bound() const;
+  // graph structure by literal index
+  const std::vector<int>& get_children(int node) const;
+  bool is_output(int node) const;
+  // the least number of steps before node can be pebbled
+  int get_depth(int node) const;
   void show(std::ostream& out) const;
+  // the expressions written by show, in order. to write them elsewhere with
+  // the static show
+  std::vector<z3::expr_vector> shown() const;
+  static void show(std::ostream& out, const std::vector<z3::expr_vector>& e);
 
  private:
   int max_pebbles;
   int final_pebbles;
+  dag::LowerBound lower_bound;
+  std::vector<std::vector<int>> children; // literal index -> child indices
+  std::vector<bool> outputs;              // literal index -> is output
+  std::vector<int> depths;                // literal index -> dag depth
 
   z3::expr_vector initial;
   z3::expr_vector transition; // vector of clauses (cnf)
@@ -0,0 +1,44 @@
+#ifndef PEBBLE_BOUNDS_H
+#define PEBBLE_BOUNDS_H
+
+#include "dag.h"
+
+#include <string>
+#include <vector>
+
+namespace dag
+{
+  // a number of pebbles below which no (reversible) pebbling strategy of the
+  // graph can exist, together with the argument that proves it
+  struct LowerBound
+  {
+    int pebbles = 0;
+    std::string reason = "none";
+
+    std::string str() const;
+  };
+
+  // every output is pebbled in the final state
+  LowerBound output_bound(const Graph& G);
+  // a node and all its children are pebbled when it is (un)pebbled. only
+  // nodes that an output depends on
+  LowerBound fanin_bound(const Graph& G);
+  // at the last time an output o is pebbled, all outputs and the children of
+  // o are pebbled
+  LowerBound output_cut_bound(const Graph& G);
+  // black pebbling number of the fanout-free cones (in-trees) that an output
+  // depends on
+  LowerBound tree_bound(const Graph& G);
+  // a reversible pebbling of a chain of n nodes requires 1 + ceil(log2 n)
+  // pebbles. uses the longest path towards an output
+  LowerBound chain_bound(const Graph& G);
+
+  // the strongest of all the above
+  LowerBound pebbling_lower_bound(const Graph& G);
+
+  // the least number of steps needed to pebble each node from the empty
+  // state: 1 for nodes with only inputs as children. indexed by node
+  std::vector<int> node_depths(const Graph& G);
+} // namespace dag
+
+#endif // PEBBLE_BOUNDS_H
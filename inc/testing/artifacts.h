@@ -0,0 +1,129 @@
+#ifndef PDR_ARTIFACTS_H
+#define PDR_ARTIFACTS_H
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <z3++.h>
+
+// the output that is not needed to run or judge pdr: the graph and model
+// descriptions and the solver dump. written on a thread of its own, so the
+// solver pipeline does not wait for it
+namespace pdr
+{
+  enum class Artifacts
+  {
+    none,    // not written
+    summary, // only sizes
+    full     // everything
+  };
+
+  inline Artifacts parse_artifacts(const std::string& s)
+  {
+    if (s == "none")
+      return Artifacts::none;
+    if (s == "summary")
+      return Artifacts::summary;
+    if (s == "full")
+      return Artifacts::full;
+    throw std::invalid_argument("artifacts must be none, summary or full");
+  }
+
+  // a copy of expressions in a z3 context of its own. a context is not thread
+  // safe: the copy can be printed on another thread while the solvers keep
+  // using the original. copying is linear, printing is much slower
+  class ExprSnapshot
+  {
+   private:
+    z3::context ctx; // outlives parts
+    std::vector<z3::expr_vector> parts;
+
+   public:
+    ExprSnapshot(const std::vector<z3::expr_vector>& from)
+    {
+      parts.reserve(from.size());
+      for (const z3::expr_vector& v : from)
+      {
+        Z3_ast_vector copy = Z3_ast_vector_translate(v.ctx(), v, ctx);
+        v.ctx().check_error(); // throws, instead of a null vector
+        parts.emplace_back(ctx, copy);
+      }
+    }
+
+    ExprSnapshot(const ExprSnapshot&)            = delete;
+    ExprSnapshot& operator=(const ExprSnapshot&) = delete;
+
+    const std::vector<z3::expr_vector>& get() const { return parts; }
+    const z3::expr_vector& operator[](size_t i) const { return parts.at(i); }
+  };
+
+  // runs the posted jobs in order on a thread of its own. the destructor
+  // waits for the remaining ones. a job must only use data that is not
+  // changed after posting, or a snapshot of it
+  class ArtifactWriter
+  {
+   private:
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<std::function<void()>> jobs;
+    bool stopping = false;
+    std::thread writer;
+
+    void work()
+    {
+      std::unique_lock lock(mutex);
+      while (true)
+      {
+        cv.wait(lock, [this] { return stopping || !jobs.empty(); });
+        if (jobs.empty())
+          return;
+
+        std::function<void()> job = std::move(jobs.front());
+        jobs.pop_front();
+        lock.unlock();
+        try
+        {
+          job();
+        }
+        catch (const std::exception& e)
+        {
+          std::cerr << "Failed to write artifact: " << e.what() << std::endl;
+        }
+        lock.lock();
+      }
+    }
+
+   public:
+    ArtifactWriter() : writer(&ArtifactWriter::work, this) {}
+
+    ~ArtifactWriter()
+    {
+      {
+        std::lock_guard lock(mutex);
+        stopping = true;
+      }
+      cv.notify_one();
+      writer.join();
+    }
+
+    ArtifactWriter(const ArtifactWriter&)            = delete;
+    ArtifactWriter& operator=(const ArtifactWriter&) = delete;
+
+    void post(std::function<void()> job)
+    {
+      {
+        std::lock_guard lock(mutex);
+        jobs.push_back(std::move(job));
+      }
+      cv.notify_one();
+    }
+  };
+} // namespace pdr
+#endif // PDR_ARTIFACTS_H
@@ -2,15 +2,25 @@
 #define PDR_LOGGER_H
 
 #include "dag.h"
+#include "profiler.h"
+#include "progress.h"
+#include "query-log.h"
 #include "stats.h"
+#include "timeline.h"
+#include "tracer.h"
 
+#include <algorithm>
+#include <chrono>
+#include <fmt/format.h>
 #include <fstream>
+#include <iterator>
 #include <memory>
 #include <ostream>
 #include <spdlog/logger.h>
 #include <spdlog/sinks/basic_file_sink.h>
 #include <spdlog/spdlog.h>
 #include <string>
+#include <string_view>
 
 enum OutLvl
 {
@@ -19,20 +29,40 @@ enum OutLvl
   verbose
 };
 
-class nullbuffer : public std::streambuf
-{
- public:
-  int overflow(int c) { return c; }
-};
+// highest output level that is compiled in, see OutLvl
+#ifndef PDR_OUT_LEVEL
+#define PDR_OUT_LEVEL 2
+#endif
 
-class nullstream : public std::ostream
-{
- public:
-  nullstream() : std::ostream(&null) {}
+// write a formatted line to the output of logger if its level is at least lvl.
+// the arguments are not evaluated if the message is not shown
+#define PDR_OUT_LVL(logger, lvl, ...)                                          \
+  do                                                                           \
+  {                                                                            \
+    if ((lvl) <= PDR_OUT_LEVEL && (logger).shows(lvl))                         \
+      (logger).show(__VA_ARGS__);                                              \
+  } while (0)
 
- private:
-  nullbuffer null;
-};
+// record a trace event, see Tracer::emit. only compiled in with LOG
+#ifdef LOG
+#define PDR_TRACE(logger, ...)                                                 \
+  do                                                                           \
+  {                                                                            \
+    if ((logger).tracer)                                                       \
+      (logger).tracer->emit((logger).indent, __VA_ARGS__);                     \
+  } while (0)
+#else
+#define PDR_TRACE(logger, ...)                                                 \
+  do                                                                           \
+  {                                                                            \
+  } while (0)
+#endif
+
+// output a message if output is verbose
+#define PDR_OUT(logger, ...) PDR_OUT_LVL(logger, OutLvl::verbose, __VA_ARGS__)
+// output an important update unless completely silent
+#define PDR_WHISPER(logger, ...)                                               \
+  PDR_OUT_LVL(logger, OutLvl::whisper, __VA_ARGS__)
 
 namespace pdr
 {
@@ -41,15 +71,24 @@ namespace pdr
    private:
     std::ofstream progress_file;
     std::ostream& _out;
-    nullstream null;
+    static constexpr unsigned max_tab = 64;
 
    public:
     std::shared_ptr<spdlog::logger> spd_logger;
+    std::unique_ptr<trace::Tracer> tracer;
+    std::unique_ptr<ProgressMonitor> monitor;
+    std::unique_ptr<queries::QueryLog> query_log;
     Statistics stats;
+    Profiler profiler;
+    Timeline timeline;
     OutLvl level;
     unsigned indent = 0;
 
-    std::string tab() const { return std::string(indent, '\t'); }
+    std::string_view tab() const
+    {
+      static const std::string tabs(max_tab, '\t');
+      return std::string_view(tabs.data(), std::min(indent, max_tab));
+    }
 
     Logger(const std::string& log_file, const dag::Graph& G, OutLvl l)
         : _out(std::cout), stats(), level(l)
@@ -72,27 +111,45 @@ namespace pdr
       spd_logger = spdlog::basic_logger_mt("pdr_logger", log_file);
       spd_logger->set_level(spdlog::level::trace);
       // spdlog::flush_every(std::chrono::seconds(20));
-      spdlog::flush_on(spdlog::level::trace);
+      // trace events go to the tracer, only flush the sparse info messages
+      spdlog::flush_on(spdlog::level::info);
 
-      stats.model.emplace("nodes", G.nodes.size());
-      stats.model.emplace("edges", G.edges.size());
-      stats.model.emplace("outputs", G.output.size());
+      stats.model.emplace("nodes", G.size());
+      stats.model.emplace("edges", G.edge_size());
+      stats.model.emplace("outputs", G.output_size());
     }
 
-    // output a message if output is verbose
-    std::ostream& out()
+    // write binary trace events of the literals in lits to trace_file
+    void start_trace(const std::string& trace_file, const ExpressionCache& lits)
     {
-      if (level == OutLvl::verbose)
-        return _out;
-      return null;
+      tracer = std::make_unique<trace::Tracer>(trace_file, lits);
     }
 
-    // output an important update unless completely silent
-    std::ostream& whisper() 
+    // log the operations of every Solver created after this to query_file
+    void record_queries(const std::string& query_file)
+    {
+      query_log = std::make_unique<queries::QueryLog>(query_file);
+    }
+
+    // append a Snapshot to progress_file every period seconds and every n
+    // obligations, if n > 0. without a monitor no snapshots are taken
+    void start_monitor(const std::string& progress_file, double period,
+                       unsigned n)
+    {
+      monitor = std::make_unique<ProgressMonitor>(
+          progress_file,
+          std::chrono::milliseconds(static_cast<long>(period * 1000)), n);
+    }
+
+    bool shows(OutLvl l) const { return level >= l; }
+
+    // use through PDR_OUT and PDR_WHISPER
+    template <typename... Args>
+    void show(fmt::format_string<Args...> format, Args&&... args)
     {
-      if (level != OutLvl::silent)
-        return _out;
-      return null;
+      fmt::format_to(std::ostreambuf_iterator<char>(_out), format,
+                     std::forward<Args>(args)...);
+      _out << std::endl;
     }
   };
 } // namespace pdr
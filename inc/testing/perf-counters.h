@@ -0,0 +1,156 @@
+#ifndef PDR_PERF_COUNTERS_H
+#define PDR_PERF_COUNTERS_H
+
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// hardware counters of the calling thread, read through perf_event_open.
+// user space only, so it works with perf_event_paranoid <= 2
+namespace pdr::perf
+{
+  enum Event
+  {
+    cycles,
+    instructions,
+    cache_misses,
+    branch_misses,
+    n_events
+  };
+
+  struct Counts
+  {
+    std::array<uint64_t, n_events> v{};
+
+    uint64_t operator[](Event e) const { return v[e]; }
+
+    Counts& operator+=(const Counts& c)
+    {
+      for (size_t i = 0; i < n_events; i++)
+        v[i] += c.v[i];
+      return *this;
+    }
+
+    Counts operator-(const Counts& c) const
+    {
+      Counts rv;
+      for (size_t i = 0; i < n_events; i++)
+        rv.v[i] = v[i] >= c.v[i] ? v[i] - c.v[i] : 0;
+      return rv;
+    }
+  };
+
+  // a group of the counters in Event that the cpu supports. if the cycle
+  // counter cannot be opened there are none, and error() tells why
+  class Counters
+  {
+   private:
+    std::array<int, n_events> fds;
+    std::array<int, n_events> slot; // index in a group read, -1 if absent
+    int n_open = 0;
+    std::string reason;
+
+#ifdef __linux__
+    int open(Event e, int group)
+    {
+      static constexpr uint64_t config[n_events] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+      };
+      perf_event_attr attr;
+      std::memset(&attr, 0, sizeof(attr));
+      attr.size           = sizeof(attr);
+      attr.type           = PERF_TYPE_HARDWARE;
+      attr.config         = config[e];
+      attr.disabled       = group == -1;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv     = 1;
+      attr.read_format    = PERF_FORMAT_GROUP |
+                         PERF_FORMAT_TOTAL_TIME_ENABLED |
+                         PERF_FORMAT_TOTAL_TIME_RUNNING;
+      return syscall(SYS_perf_event_open, &attr, 0, -1, group, 0);
+    }
+#endif
+
+   public:
+    Counters()
+    {
+      fds.fill(-1);
+      slot.fill(-1);
+#ifdef __linux__
+      fds[cycles] = open(cycles, -1);
+      if (fds[cycles] < 0)
+      {
+        reason = fmt_error();
+        return;
+      }
+      slot[cycles] = n_open++;
+      for (size_t e = cycles + 1; e < n_events; e++)
+      {
+        fds[e] = open(static_cast<Event>(e), fds[cycles]);
+        if (fds[e] >= 0)
+          slot[e] = n_open++;
+      }
+      ioctl(fds[cycles], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+      ioctl(fds[cycles], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#else
+      reason = "perf_event_open is only available on linux";
+#endif
+    }
+
+    ~Counters()
+    {
+#ifdef __linux__
+      for (int fd : fds)
+        if (fd >= 0)
+          close(fd);
+#endif
+    }
+
+    Counters(const Counters&)            = delete;
+    Counters& operator=(const Counters&) = delete;
+
+    bool available() const { return n_open > 0; }
+    bool has(Event e) const { return slot[e] >= 0; }
+    const std::string& error() const { return reason; }
+
+    // the counts since opening, scaled up if the group was multiplexed
+    Counts read() const
+    {
+      Counts rv;
+#ifdef __linux__
+      if (!available())
+        return rv;
+      // nr, time enabled, time running, a value per counter
+      std::array<uint64_t, 3 + n_events> buf;
+      if (::read(fds[cycles], buf.data(), sizeof(buf)) < 24 || buf[2] == 0)
+        return rv;
+      double scale = (double)buf[1] / buf[2];
+      for (size_t e = 0; e < n_events; e++)
+        if (slot[e] >= 0)
+          rv.v[e] = buf[3 + slot[e]] * scale;
+#endif
+      return rv;
+    }
+
+   private:
+    static std::string fmt_error()
+    {
+      int e          = errno;
+      std::string rv = std::strerror(e);
+      if (e == EACCES || e == EPERM)
+        rv += " (see /proc/sys/kernel/perf_event_paranoid)";
+      return rv;
+    }
+  };
+} // namespace pdr::perf
+#endif // PDR_PERF_COUNTERS_H
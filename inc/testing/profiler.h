@@ -0,0 +1,290 @@
+#ifndef PDR_PROFILER_H
+#define PDR_PROFILER_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <fmt/format.h>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "perf-counters.h"
+
+#ifdef PDR_ALLOC_STATS
+#include <z3.h>
+#endif
+
+// time the rest of the enclosing scope as a phase of logger.profiler
+#define PDR_PROFILE_CAT(a, b) a##b
+#define PDR_PROFILE_VAR(line) PDR_PROFILE_CAT(scoped_timer_, line)
+#define PDR_PROFILE(logger, name)                                              \
+  pdr::ScopedTimer PDR_PROFILE_VAR(__LINE__)((logger).profiler, name)
+
+namespace pdr
+{
+  // heap allocations made in a phase
+  struct AllocCount
+  {
+    uint64_t count = 0;
+    uint64_t bytes = 0;
+    // z3 allocates with malloc, not operator new. only the net change of its
+    // heap is known: objects freed in the same phase do not show
+    int64_t z3_bytes = 0;
+
+    AllocCount& operator+=(const AllocCount& a)
+    {
+      count += a.count;
+      bytes += a.bytes;
+      z3_bytes += a.z3_bytes;
+      return *this;
+    }
+  };
+
+  // the counter of the current phase of this thread, if any. operator new
+  // adds to it in builds with ALLOC_STATS, see alloc-stats.cpp
+  inline thread_local AllocCount* alloc_phase = nullptr;
+
+  // call tree of the phases timed by ScopedTimer. a phase is identified by its
+  // name and the path of phases that entered it
+  class Profiler
+  {
+   private:
+    struct Node
+    {
+      const char* name;
+      size_t parent;
+      std::vector<size_t> children;
+      uint64_t count       = 0;
+      uint64_t inclusive   = 0; // ns
+      uint64_t in_children = 0; // ns
+      AllocCount allocs;        // while this is the current phase
+      perf::Counts hw;          // inclusive
+      perf::Counts hw_entered;  // at the last enter
+
+      Node(const char* n, size_t p) : name(n), parent(p) {}
+      uint64_t exclusive() const { return inclusive - in_children; }
+    };
+
+    // a deque keeps alloc_phase valid while nodes are added
+    std::deque<Node> nodes = { Node("root", 0) };
+    size_t current         = 0;
+    // none unless count_hardware() is called
+    std::unique_ptr<perf::Counters> counters;
+
+#ifdef PDR_ALLOC_STATS
+    uint64_t z3_mark = Z3_get_estimated_alloc_size();
+#endif
+
+    void set_current(size_t i)
+    {
+#ifdef PDR_ALLOC_STATS
+      // the change of z3's heap since the last switch is the old phase's
+      uint64_t z3_now = Z3_get_estimated_alloc_size();
+      nodes[current].allocs.z3_bytes += static_cast<int64_t>(z3_now - z3_mark);
+      z3_mark = z3_now;
+#endif
+      current     = i;
+      alloc_phase = &nodes[i].allocs;
+    }
+
+    AllocCount inclusive_allocs(size_t i) const
+    {
+      AllocCount rv = nodes[i].allocs;
+      for (size_t c : nodes[i].children)
+        rv += inclusive_allocs(c);
+      return rv;
+    }
+
+    std::string path(size_t i) const
+    {
+      if (i == 0)
+        return "";
+      std::string parent = path(nodes[i].parent);
+      return parent.empty() ? nodes[i].name : parent + ";" + nodes[i].name;
+    }
+
+    void show(std::ostream& out, size_t i, unsigned depth, bool allocs) const
+    {
+      const Node& n = nodes[i];
+      out << fmt::format("# {:<{}}{:<{}} count: {:<10} incl: {:<12.6f} "
+                         "excl: {:.6f}",
+                         "", 2 * depth, n.name, 28 - 2 * depth, n.count,
+                         n.inclusive / 1e9, n.exclusive() / 1e9);
+      if (allocs)
+      {
+        AllocCount a = inclusive_allocs(i);
+        out << fmt::format(" allocs: {:<12} bytes: {:<14} excl allocs: {:<12} "
+                           "z3 net bytes: {}",
+                           a.count, a.bytes, n.allocs.count, a.z3_bytes);
+      }
+      out << std::endl;
+      for (size_t c : n.children)
+        show(out, c, depth + 1, allocs);
+    }
+
+    // ipc and misses per 1000 instructions, "-" for a missing counter
+    void show_hardware(std::ostream& out, size_t i, unsigned depth) const
+    {
+      const Node& n      = nodes[i];
+      const double instr = n.hw[perf::instructions];
+      auto per_instr     = [&](perf::Event e, double factor) -> std::string
+      {
+        if (!counters->has(e) || !counters->has(perf::instructions) ||
+            instr == 0)
+          return "-";
+        return fmt::format("{:.3f}", n.hw[e] * factor / instr);
+      };
+      std::string ipc = "-";
+      if (counters->has(perf::instructions) && n.hw[perf::cycles] > 0)
+        ipc = fmt::format("{:.3f}", instr / n.hw[perf::cycles]);
+      out << fmt::format("# {:<{}}{:<{}} cycles: {:<14} instr: {:<14} "
+                         "ipc: {:<7} cache mpki: {:<8} branch mpki: {}",
+                         "", 2 * depth, n.name, 28 - 2 * depth,
+                         n.hw[perf::cycles], n.hw[perf::instructions], ipc,
+                         per_instr(perf::cache_misses, 1000),
+                         per_instr(perf::branch_misses, 1000))
+          << std::endl;
+      for (size_t c : n.children)
+        show_hardware(out, c, depth + 1);
+    }
+
+   public:
+    Profiler() { set_current(0); }
+    ~Profiler() { alloc_phase = nullptr; }
+    Profiler(const Profiler&)            = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    // also read the hardware counters at every enter and leave. returns false
+    // if they are not available, see hardware_error()
+    bool count_hardware()
+    {
+      counters = std::make_unique<perf::Counters>();
+      if (!counters->available())
+        return false;
+      nodes[0].hw_entered = counters->read();
+      return true;
+    }
+    bool counts_hardware() const { return counters && counters->available(); }
+    std::string hardware_error() const
+    {
+      return counters ? counters->error() : "not enabled";
+    }
+
+    // enter the phase name, nested in the current phase. name must outlive
+    // the profiler
+    size_t enter(const char* name)
+    {
+      size_t node = nodes.size();
+      for (size_t c : nodes[current].children)
+        if (nodes[c].name == name || std::strcmp(nodes[c].name, name) == 0)
+          node = c;
+
+      if (node == nodes.size())
+      {
+        nodes.emplace_back(name, current);
+        nodes[current].children.push_back(node);
+      }
+      set_current(node);
+      if (counts_hardware())
+        nodes[node].hw_entered = counters->read();
+      return node;
+    }
+
+    void leave(size_t node, uint64_t ns)
+    {
+      Node& n = nodes[node];
+      if (counts_hardware())
+        n.hw += counters->read() - n.hw_entered;
+      n.count++;
+      n.inclusive += ns;
+      nodes[n.parent].in_children += ns;
+      set_current(n.parent);
+    }
+
+    // if operator new is counted, in builds with ALLOC_STATS
+    bool counts_allocs() const { return inclusive_allocs(0).count > 0; }
+    AllocCount total_allocs() const { return inclusive_allocs(0); }
+
+    // add a phase under the root that was measured before the profiler
+    // existed
+    void record(const char* name, uint64_t ns, const perf::Counts& hw)
+    {
+      size_t node = enter(name);
+      leave(node, ns);
+      nodes[node].hw += hw;
+    }
+
+    // one line per phase: the path of phases and its exclusive time in us.
+    // the folded format of flamegraph.pl and speedscope
+    void collapsed(std::ostream& out) const
+    {
+      for (size_t i = 1; i < nodes.size(); i++)
+        if (nodes[i].exclusive() >= 1000)
+          out << path(i) << " " << nodes[i].exclusive() / 1000 << '\n';
+    }
+
+    friend std::ostream& operator<<(std::ostream& out, const Profiler& p)
+    {
+      out << "######################" << std::endl
+          << "# Profile (s)" << std::endl
+          << "######################" << std::endl;
+      bool allocs = p.counts_allocs();
+      for (size_t c : p.nodes[0].children)
+        p.show(out, c, 0, allocs);
+      if (allocs)
+      {
+        AllocCount total = p.total_allocs();
+        out << fmt::format("# heap allocations: {} ({} bytes), {} outside "
+                           "any phase",
+                           total.count, total.bytes, p.nodes[0].allocs.count)
+            << std::endl
+            << fmt::format("# z3 heap: {:+} bytes net. z3 allocates outside "
+                           "operator new, its allocations are not counted",
+                           total.z3_bytes)
+            << std::endl;
+      }
+      if (p.counters)
+      {
+        out << "######################" << std::endl
+            << "# Hardware counters (inclusive)" << std::endl
+            << "######################" << std::endl;
+        if (!p.counts_hardware())
+          out << "# unavailable: " << p.hardware_error() << std::endl;
+        else
+          for (size_t c : p.nodes[0].children)
+            p.show_hardware(out, c, 0);
+      }
+      return out << "######################" << std::endl;
+    }
+  };
+
+  // times its lifetime as the phase name in p
+  class ScopedTimer
+  {
+   private:
+    using clock = std::chrono::steady_clock;
+
+    Profiler& profiler;
+    size_t node;
+    clock::time_point start;
+
+   public:
+    ScopedTimer(Profiler& p, const char* name)
+        : profiler(p), node(p.enter(name)), start(clock::now())
+    {
+    }
+    ~ScopedTimer()
+    {
+      auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+          clock::now() - start);
+      profiler.leave(node, ns.count());
+    }
+
+    ScopedTimer(const ScopedTimer&)            = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+  };
+} // namespace pdr
+#endif // PDR_PROFILER_H
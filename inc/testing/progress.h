@@ -0,0 +1,168 @@
+#ifndef PDR_PROGRESS_H
+#define PDR_PROGRESS_H
+
+#include "stats.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fmt/format.h>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+namespace pdr
+{
+  // the state of the algorithm at one point, copied by the pdr thread
+  struct Snapshot
+  {
+    unsigned k;
+    // blocked cubes per frame
+    std::vector<size_t> frame_sizes;
+    size_t inf_size;
+    size_t obligations;
+    unsigned obligations_handled;
+    unsigned solver_calls;
+    decltype(Statistics::query_latency) query_latency;
+  };
+
+  // appends a json line with a Snapshot to a file every period, and every
+  // n obligations unless n is 0. the pdr thread only checks due() and copies the
+  // snapshot, formatting and writing happen on a background thread
+  class ProgressMonitor
+  {
+   private:
+    std::ofstream file;
+    const std::chrono::steady_clock::time_point start;
+    const std::chrono::milliseconds period;
+    const unsigned every_n;
+    unsigned since_last = 0;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::atomic<bool> requested{ false };
+    bool stopping = false;
+    std::optional<Snapshot> pending;
+    std::thread writer;
+
+    // resident set size in bytes, -1 if unknown
+    static long rss()
+    {
+#ifdef __linux__
+      std::ifstream statm("/proc/self/statm");
+      long pages, resident;
+      if (statm >> pages >> resident)
+        return resident * sysconf(_SC_PAGESIZE);
+#endif
+      return -1;
+    }
+
+    void write(const Snapshot& s, double time)
+    {
+      std::string frames;
+      for (size_t i = 0; i < s.frame_sizes.size(); i++)
+        frames += fmt::format("{}{}", i > 0 ? ", " : "", s.frame_sizes[i]);
+
+      std::string queries;
+      for (size_t q = 0; q < s.query_latency.size(); q++)
+        for (bool sat : { false, true })
+        {
+          const Histogram& h = s.query_latency[q][sat];
+          if (h.total_count == 0)
+            continue;
+          queries += fmt::format(
+              "{}\"{}_{}\": {{\"n\": {}, \"p50_us\": {}, \"p99_us\": {}, "
+              "\"max_us\": {}}}",
+              queries.empty() ? "" : ", ", query_name(static_cast<Query>(q)),
+              sat ? "sat" : "unsat", h.total_count,
+              h.percentile(0.5) / 1e3, h.percentile(0.99) / 1e3, h.max / 1e3);
+        }
+
+      file << fmt::format(
+                  "{{\"time\": {:.3f}, \"k\": {}, \"frames\": [{}], "
+                  "\"inf\": {}, \"obligations\": {}, "
+                  "\"obligations_handled\": {}, \"solver_calls\": {}, "
+                  "\"queries\": {{{}}}, \"rss\": {}}}",
+                  time, s.k, frames, s.inf_size, s.obligations,
+                  s.obligations_handled, s.solver_calls, queries, rss())
+           << std::endl;
+    }
+
+    void run()
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      while (true)
+      {
+        bool woken = cv.wait_for(lock, period,
+                                 [this]() { return stopping || pending; });
+        if (!woken) // ask the pdr thread for a snapshot
+        {
+          requested.store(true, std::memory_order_relaxed);
+          continue;
+        }
+        if (!pending) // stopping, with nothing left to write
+          return;
+
+        Snapshot s = std::move(*pending);
+        pending.reset();
+        std::chrono::duration<double> time(std::chrono::steady_clock::now() -
+                                           start);
+        lock.unlock();
+        write(s, time.count());
+        lock.lock();
+      }
+    }
+
+   public:
+    ProgressMonitor(const std::string& filename,
+                    std::chrono::milliseconds p, unsigned n)
+        : file(filename, std::fstream::out | std::fstream::trunc),
+          start(std::chrono::steady_clock::now()), period(p), every_n(n)
+    {
+      if (!file.is_open())
+        throw std::runtime_error("Failed to open " + filename);
+      writer = std::thread([this]() { run(); });
+    }
+
+    ~ProgressMonitor()
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+      }
+      cv.notify_one();
+      writer.join();
+    }
+
+    ProgressMonitor(const ProgressMonitor&)            = delete;
+    ProgressMonitor& operator=(const ProgressMonitor&) = delete;
+
+    // called by the pdr thread after every obligation, returns if it
+    // should publish() a snapshot
+    bool due()
+    {
+      return (every_n > 0 && ++since_last >= every_n) ||
+             requested.load(std::memory_order_relaxed);
+    }
+
+    void publish(Snapshot&& s)
+    {
+      since_last = 0;
+      requested.store(false, std::memory_order_relaxed);
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending = std::move(s);
+      }
+      cv.notify_one();
+    }
+  };
+} // namespace pdr
+#endif // PDR_PROGRESS_H
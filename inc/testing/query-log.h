@@ -0,0 +1,176 @@
+#ifndef PDR_QUERY_LOG_H
+#define PDR_QUERY_LOG_H
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <z3++.h>
+
+// the binary log of the operations on every pdr::Solver, written by QueryLog
+// and re-executed by query-replay.
+// file: magic, version (u32 each), then a stream of records: an Op (u8) and
+// its fields. strings are a u32 length and its chars
+//   declare: name                   a Bool constant
+//   expr:    smt2 text              expressions are numbered in order
+//   solver:  u32 solver             a new solver
+//   param:   u32 solver, key, value
+//   add:     u32 solver, u32 expr
+//   check:   u32 solver, u32 n, n * u32 expr, u8 result, f64 seconds
+//   reset:   u32 solver
+namespace pdr::queries
+{
+  constexpr uint32_t magic   = 0x51524450; // "PDRQ"
+  constexpr uint32_t version = 1;
+
+  enum class Op : uint8_t
+  {
+    declare,
+    expr,
+    solver,
+    param,
+    add,
+    check,
+    reset
+  };
+
+  // the result of a check
+  enum Result : uint8_t
+  {
+    unsat,
+    sat,
+    unknown
+  };
+
+  // writes a record of every solver operation. an expression is written once,
+  // later records refer to its number. keeps the expressions alive, so their
+  // ast ids are not reused
+  class QueryLog
+  {
+   private:
+    std::ofstream file;
+    std::unordered_map<unsigned, uint32_t> numbers; // ast id -> expr
+    std::vector<z3::expr> alive;
+    std::unordered_set<unsigned> visited; // ast ids searched for constants
+    uint32_t n_solvers = 0;
+
+    template <typename T> void put(T x)
+    {
+      file.write(reinterpret_cast<const char*>(&x), sizeof(T));
+    }
+    void put(const std::string& s)
+    {
+      put<uint32_t>(s.size());
+      file.write(s.data(), s.size());
+    }
+    void put(Op op) { put<uint8_t>(static_cast<uint8_t>(op)); }
+
+    // declares the constants in e that were not seen before
+    void declare(const z3::expr& e)
+    {
+      std::vector<z3::expr> todo = { e };
+      while (!todo.empty())
+      {
+        z3::expr next = todo.back();
+        todo.pop_back();
+        if (!next.is_app() || !visited.insert(next.id()).second)
+          continue;
+
+        if (next.is_const() && next.decl().decl_kind() == Z3_OP_UNINTERPRETED)
+        {
+          if (!next.is_bool())
+            throw std::invalid_argument("QueryLog only declares Bool "
+                                        "constants: " +
+                                        next.to_string());
+          put(Op::declare);
+          put(next.decl().name().str());
+        }
+        for (unsigned i = 0; i < next.num_args(); i++)
+          todo.push_back(next.arg(i));
+      }
+    }
+
+    // the number of e, writes it first if it is new
+    uint32_t number(const z3::expr& e)
+    {
+      auto [it, inserted] = numbers.emplace(e.id(), alive.size());
+      if (inserted)
+      {
+        declare(e);
+        put(Op::expr);
+        put(e.to_string());
+        alive.push_back(e);
+      }
+      return it->second;
+    }
+
+   public:
+    QueryLog(const std::string& filename)
+        : file(filename, std::ios::binary | std::ios::trunc)
+    {
+      if (!file.is_open())
+        throw std::runtime_error("Failed to open " + filename);
+      put(magic);
+      put(version);
+    }
+
+    ~QueryLog() { file.flush(); }
+
+    QueryLog(const QueryLog&)            = delete;
+    QueryLog& operator=(const QueryLog&) = delete;
+
+    uint32_t new_solver()
+    {
+      put(Op::solver);
+      put(n_solvers);
+      return n_solvers++;
+    }
+
+    void param(uint32_t solver, const std::string& key,
+               const std::string& value)
+    {
+      put(Op::param);
+      put(solver);
+      put(key);
+      put(value);
+    }
+
+    void add(uint32_t solver, const z3::expr& e)
+    {
+      uint32_t n = number(e);
+      put(Op::add);
+      put(solver);
+      put(n);
+    }
+
+    void check(uint32_t solver, z3::context& ctx, const Z3_ast* assumptions,
+               unsigned n, Z3_lbool result, double seconds)
+    {
+      std::vector<uint32_t> ns;
+      ns.reserve(n);
+      for (unsigned i = 0; i < n; i++)
+        ns.push_back(number(z3::expr(ctx, assumptions[i])));
+
+      put(Op::check);
+      put(solver);
+      put(n);
+      file.write(reinterpret_cast<const char*>(ns.data()),
+                 n * sizeof(uint32_t));
+      put<uint8_t>(result == Z3_L_TRUE    ? Result::sat
+                   : result == Z3_L_FALSE ? Result::unsat
+                                          : Result::unknown);
+      put(seconds);
+    }
+
+    void reset(uint32_t solver)
+    {
+      put(Op::reset);
+      put(solver);
+    }
+  };
+} // namespace pdr::queries
+#endif // PDR_QUERY_LOG_H
@@ -1,12 +1,17 @@
 #ifndef STATS_H
 #define STATS_H
 
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <fmt/core.h>
 #include <fmt/format.h>
 #include <iostream>
 #include <map>
+#include <optional>
 #include <ostream>
 #include <sstream>
 #include <string>
@@ -85,6 +90,129 @@ namespace pdr
     }
   };
 
+  // log-linear latency histogram in nanoseconds (HDR-style): every power of
+  // two is split into 2^sub_bits buckets, so a bucket is within 1/16 of its
+  // values
+  struct Histogram
+  {
+    static constexpr unsigned sub_bits = 4;
+    static constexpr uint64_t sub_count = 1u << sub_bits;
+
+    uint64_t total_count = 0;
+    uint64_t max         = 0;
+    std::vector<uint64_t> buckets;
+
+    static unsigned log2(uint64_t v)
+    {
+#if defined(__GNUC__)
+      return 63 - __builtin_clzll(v);
+#else
+      unsigned e = 0;
+      while (v >>= 1)
+        e++;
+      return e;
+#endif
+    }
+
+    static size_t index(uint64_t v)
+    {
+      if (v < sub_count)
+        return v;
+      unsigned shift = log2(v) - sub_bits;
+      return ((shift + 1) << sub_bits) + (v >> shift) - sub_count;
+    }
+
+    // the highest value in bucket i
+    static uint64_t upper(size_t i)
+    {
+      if (i < sub_count)
+        return i;
+      unsigned shift = (i >> sub_bits) - 1;
+      uint64_t m     = (i & (sub_count - 1)) + sub_count;
+      return ((m + 1) << shift) - 1;
+    }
+
+    void add(uint64_t ns)
+    {
+      size_t i = index(ns);
+      if (buckets.size() <= i)
+        buckets.resize(i + 1, 0);
+      buckets[i]++;
+      total_count++;
+      max = std::max(max, ns);
+    }
+
+    // the value below which a fraction p of the samples falls
+    uint64_t percentile(double p) const
+    {
+      uint64_t target = std::max<uint64_t>(1, std::ceil(p * total_count));
+      uint64_t seen   = 0;
+      for (size_t i = 0; i < buckets.size(); i++)
+      {
+        seen += buckets[i];
+        if (seen >= target)
+          return std::min(upper(i), max);
+      }
+      return max;
+    }
+  };
+
+  // the kinds of SAT queries, see Frames
+  enum class Query
+  {
+    initiation,  // I => P, I & T => P', I => !c
+    cti,         // F_k & T & !P'
+    consecution, // F_i & !s & T & s', while blocking
+    propagation, // F_i & T & s', while pushing lemmas forward
+    mic,         // consecution and initiation in MIC's down
+    mining,      // F_inf & !s & T & s', for F_inf lemmas
+    N
+  };
+
+  inline const char* query_name(Query q)
+  {
+    static constexpr std::array<const char*, static_cast<size_t>(Query::N)>
+        names = { "initiation", "cti",  "consecution",
+                  "propagation", "mic", "mining" };
+    return names.at(static_cast<size_t>(q));
+  }
+
+  // counters of the z3 statistics of a Solver, summed over its resets
+  struct SolverStats
+  {
+    uint64_t conflicts       = 0;
+    uint64_t decisions       = 0;
+    uint64_t propagations    = 0;
+    uint64_t restarts        = 0;
+    // cardinality constraints, with cardinality.solver
+    uint64_t pb_conflicts    = 0;
+    uint64_t pb_propagations = 0;
+    double max_memory        = 0; // MB, of the whole process
+    unsigned assertions      = 0; // currently in the solver
+
+    SolverStats& operator+=(const SolverStats& s)
+    {
+      conflicts += s.conflicts;
+      decisions += s.decisions;
+      propagations += s.propagations;
+      restarts += s.restarts;
+      pb_conflicts += s.pb_conflicts;
+      pb_propagations += s.pb_propagations;
+      max_memory = std::max(max_memory, s.max_memory);
+      assertions += s.assertions;
+      return *this;
+    }
+
+    std::string str() const
+    {
+      return fmt::format("conflicts={:<9} decisions={:<9} props={:<10} "
+                         "restarts={:<6} pb_conflicts={:<8} pb_props={:<10} "
+                         "assertions={}",
+                         conflicts, decisions, propagations, restarts,
+                         pb_conflicts, pb_propagations, assertions);
+    }
+  };
+
   class Statistics
   {
 
@@ -95,6 +223,27 @@ namespace pdr
     Statistic obligations_handled;
 
     Statistic subsumed_cubes;
+    Statistic mic_calls;
+    Statistic down_calls;
+    Statistic mined_invariants;
+    Statistic inf_lemmas;
+    Statistic reachable_hits;
+    Statistic sim_rejections;
+    Statistic sat_rejections;
+    // expression vectors built per solver query, see z3ext::vectors_built
+    Statistic query_vectors;
+    // latency per query type, for unsat [0] and sat [1] results
+    std::array<std::array<Histogram, 2>, static_cast<size_t>(Query::N)>
+        query_latency;
+
+    // z3 statistics of the solver of each frame, at the end of the run.
+    // with delta frames only F_0 has its own solver, the others share
+    // delta_solver
+    std::vector<SolverStats> frame_solvers;
+    std::optional<SolverStats> delta_solver;
+    SolverStats inf_solver;
+    // lemmas in each frame, at the end of the run
+    std::vector<size_t> frame_lemmas;
 
     double elapsed = -1.0;
     std::map<std::string, unsigned> model;
@@ -105,6 +254,12 @@ namespace pdr
     {
     }
 
+    void add_query(Query q, bool sat, double seconds)
+    {
+      query_latency.at(static_cast<size_t>(q))[sat].add(
+          static_cast<uint64_t>(seconds * 1e9));
+    }
+
     std::string to_string() const
     {
       std::stringstream ss;
@@ -134,12 +289,69 @@ namespace pdr
           << "######################" << std::endl;
 
       out << "# Solver" << std::endl << s.solver_calls << std::endl;
+      out << "# Solver latency per query (us)" << std::endl;
+      for (size_t q = 0; q < s.query_latency.size(); q++)
+        for (bool sat : { false, true })
+        {
+          const Histogram& h = s.query_latency[q][sat];
+          if (h.total_count == 0)
+            continue;
+          auto us = [](uint64_t ns) { return ns / 1000.0; };
+          out << fmt::format("# - {:<12} {:<5}: n={:<8} p50={:<10} "
+                             "p90={:<10} p99={:<10} max={}",
+                             query_name(static_cast<Query>(q)),
+                             sat ? "sat" : "unsat", h.total_count,
+                             us(h.percentile(0.5)), us(h.percentile(0.9)),
+                             us(h.percentile(0.99)), us(h.max))
+              << std::endl;
+        }
+      out << "###" << std::endl;
+      out << "# Z3 statistics per solver" << std::endl;
+      SolverStats total;
+      for (size_t i = 0; i < s.frame_lemmas.size(); i++)
+      {
+        out << fmt::format("# - F_{:<3} lemmas={:<7} ", i, s.frame_lemmas[i]);
+        if (i < s.frame_solvers.size())
+        {
+          out << s.frame_solvers[i].str();
+          total += s.frame_solvers[i];
+        }
+        out << std::endl;
+      }
+      if (s.delta_solver)
+      {
+        out << "# - delta  " << s.delta_solver->str() << std::endl;
+        total += *s.delta_solver;
+      }
+      out << "# - F_inf  " << s.inf_solver.str() << std::endl;
+      total += s.inf_solver;
+      out << "# - total  " << total.str() << std::endl;
+      out << "# - max memory: " << total.max_memory << " MB" << std::endl;
+      out << "###" << std::endl;
+      out << "# Vectors built in solver queries" << std::endl
+          << s.query_vectors << std::endl;
+      if (s.solver_calls.total_count > 0)
+        out << "# - per query: "
+            << (double)s.query_vectors.total_count / s.solver_calls.total_count
+            << std::endl;
       out << "# Obligations" << std::endl << s.obligations_handled << std::endl;
       out << "# Propagation per iteration" << std::endl
           << s.propagation_it << std::endl;
       out << "# Propagation per level" << std::endl
           << s.propagation_level << std::endl;
       out << "# Subsumed clauses" << std::endl << s.subsumed_cubes << std::endl;
+      out << "# MIC calls" << std::endl << s.mic_calls << std::endl;
+      out << "# Down calls" << std::endl << s.down_calls << std::endl;
+      out << "# Mined invariants" << std::endl
+          << s.mined_invariants << std::endl;
+      out << "# Lemmas moved to F_inf" << std::endl
+          << s.inf_lemmas << std::endl;
+      out << "# Reachable state cache hits" << std::endl
+          << s.reachable_hits << std::endl;
+      out << "# Down rejected by simulation" << std::endl
+          << s.sim_rejections << std::endl;
+      out << "# Down rejected by SAT (intersects I)" << std::endl
+          << s.sat_rejections << std::endl;
       out << "#" << std::endl;
 
       return out << "######################" << std::endl;
@@ -0,0 +1,131 @@
+#ifndef PDR_TIMELINE_H
+#define PDR_TIMELINE_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <fmt/format.h>
+#include <initializer_list>
+#include <ostream>
+#include <vector>
+
+namespace pdr
+{
+  // spans of the run, written as Chrome trace_event JSON for Perfetto or
+  // chrome://tracing. spans are kept in memory until write(), recording
+  // only reads the clock and appends
+  class Timeline
+  {
+   public:
+    using clock = std::chrono::steady_clock;
+
+    // a named integer argument, or a string if str is set
+    struct Arg
+    {
+      const char* key = nullptr;
+      int64_t value   = 0;
+      const char* str = nullptr;
+    };
+    static constexpr size_t max_args = 3;
+
+    struct Span
+    {
+      const char* name;
+      uint64_t start; // ns since the start of the timeline
+      uint64_t duration;
+      std::array<Arg, max_args> args;
+    };
+
+   private:
+    bool on = false;
+    clock::time_point origin;
+    std::vector<Span> spans;
+
+    uint64_t since_origin(clock::time_point t) const
+    {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(t - origin)
+          .count();
+    }
+
+   public:
+    bool enabled() const { return on; }
+    void enable()
+    {
+      on     = true;
+      origin = clock::now();
+    }
+
+    void add(const char* name, clock::time_point start,
+             const std::array<Arg, max_args>& args)
+    {
+      uint64_t begin = since_origin(start);
+      spans.push_back({ name, begin, since_origin(clock::now()) - begin, args });
+    }
+
+    void write(std::ostream& out) const
+    {
+      out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+      for (size_t i = 0; i < spans.size(); i++)
+      {
+        const Span& s = spans[i];
+        out << fmt::format("{{\"name\": \"{}\", \"cat\": \"pdr\", \"ph\": "
+                           "\"X\", \"pid\": 1, \"tid\": 1, \"ts\": {:.3f}, "
+                           "\"dur\": {:.3f}, \"args\": {{",
+                           s.name, s.start / 1e3, s.duration / 1e3);
+        bool first = true;
+        for (const Arg& a : s.args)
+        {
+          if (!a.key)
+            continue;
+          out << (first ? "" : ", ");
+          if (a.str)
+            out << fmt::format("\"{}\": \"{}\"", a.key, a.str);
+          else
+            out << fmt::format("\"{}\": {}", a.key, a.value);
+          first = false;
+        }
+        out << (i + 1 < spans.size() ? "}},\n" : "}}\n");
+      }
+      out << "]}" << std::endl;
+    }
+  };
+
+  // records its lifetime as a span of t, if t is enabled
+  class TimelineSpan
+  {
+   private:
+    Timeline& timeline;
+    const char* name;
+    Timeline::clock::time_point start;
+    std::array<Timeline::Arg, Timeline::max_args> args;
+    size_t n_args = 0;
+
+   public:
+    TimelineSpan(Timeline& t, const char* n,
+                 std::initializer_list<Timeline::Arg> a = {})
+        : timeline(t), name(n)
+    {
+      if (!timeline.enabled())
+        return;
+      start = Timeline::clock::now();
+      for (const Timeline::Arg& arg : a)
+        set(arg);
+    }
+    ~TimelineSpan()
+    {
+      if (timeline.enabled())
+        timeline.add(name, start, args);
+    }
+
+    // add an argument that is known after the start of the span
+    void set(const Timeline::Arg& arg)
+    {
+      if (n_args < args.size())
+        args[n_args++] = arg;
+    }
+
+    TimelineSpan(const TimelineSpan&)            = delete;
+    TimelineSpan& operator=(const TimelineSpan&) = delete;
+  };
+} // namespace pdr
+#endif // PDR_TIMELINE_H
@@ -0,0 +1,112 @@
+#ifndef PDR_TRACE_FORMAT_H
+#define PDR_TRACE_FORMAT_H
+
+#include "output.h"
+
+#include <array>
+#include <cstdint>
+
+// the binary trace written by the Tracer and read by trace-decode.
+// file: Header, the names of the literal variables (u32 length + chars each),
+// then a stream of records. a record is a RecordHead followed by n_lits
+// literals (u32, see lit.h)
+namespace pdr::trace
+{
+  constexpr uint32_t magic   = 0x54524450; // "PDRT"
+  constexpr uint32_t version = 1;
+
+  // set on a literal in the next state
+  constexpr uint32_t primed = 1u << 31;
+  // an assumption that is not a literal of the model
+  constexpr uint32_t no_lit = UINT32_MAX;
+
+  struct Header
+  {
+    uint32_t magic;
+    uint32_t version;
+    int64_t start_ns; // system_clock at the start of the trace
+    uint32_t n_vars;
+  };
+
+  struct RecordHead
+  {
+    uint64_t time_ns; // since start_ns
+    uint16_t event;
+    uint16_t indent;
+    uint32_t n_lits;
+    double a;
+    double b;
+  };
+
+  enum class Event : uint16_t
+  {
+    iteration,
+    no_cti,
+    cti,
+    block,
+    top_obligation,
+    pred,
+    push,
+    finish,
+    obligation_pred,
+    obligation_finish,
+    propagation,
+    propagate,
+    remove,
+    blocked_in,
+    already_blocked,
+    blocked_inf,
+    inductive,
+    transition,
+    assumptions,
+    check_init,
+    check_fat,
+    check_delta,
+    intersects_init,
+    highest_inductive,
+    core_reduction,
+    generalize,
+    mic_reduction,
+    mining,
+    lemma,
+    N
+  };
+
+  // the text of each event, as in the spdlog trace. arguments: {0} the
+  // indentation, {1} and {2} the numbers of the record, {3} the cube. every
+  // line is a separate log line
+  constexpr std::array<const char*, static_cast<size_t>(Event::N)> formats = {
+    "\n" SEP3 "\n{0}| frame {1}",
+    "{0}| no more counters at F_{1}",
+    SEP2 "\n{0}| cti at frame {1}\n{0}| [{3}]",
+    "{0}| block",
+    SEP "\n{0}| obligations pending: {1}\n{0}| top obligation\n"
+        "{0}\t| {2}, [{3}]",
+    "{0}| predecessor:\n{0}\t| [{3}]",
+    "{0}| pred is inductive until F_{1}\n"
+    "{0}| push predecessor to level {2}: [{3}]",
+    "{0}| finishing state\n{0}\t| [{3}]",
+    "Obligation (pred)   elapsed {1}",
+    "Obligation (finish) elapsed {1}",
+    "Propagation elapsed {1}",
+    "{0}| propagate frame {1} to {2}",
+    "{0}| removing cube from level [1..{1}]: [{3}]",
+    "{0}| blocked in {1}",
+    "already blocked in F{1} by {3}",
+    "{0}| blocked in F_inf: [{3}]",
+    "{0}| check relative inductiveness, frame {1}",
+    "{0}| transition check, frame {1}",
+    "{0}\t| assumps: [ {3} ]",
+    "{0}| I check",
+    "{0}| fat check",
+    "{0}| delta check",
+    "{0}| Intersects I",
+    "{0}| highest inductive frame is {1}",
+    "{0}| reduction by unsat core: {1} -> {2}",
+    "{0}| generalize",
+    "{0}| reduction by MIC: {1} -> {2}",
+    "{0}| mining invariants",
+    "{0}| lemma in F_{1}: [{3}]",
+  };
+} // namespace pdr::trace
+#endif // PDR_TRACE_FORMAT_H
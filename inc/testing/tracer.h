@@ -0,0 +1,227 @@
+#ifndef PDR_TRACER_H
+#define PDR_TRACER_H
+
+#include "exp-cache.h"
+#include "lit.h"
+#include "trace-format.h"
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <z3++.h>
+
+namespace pdr::trace
+{
+  // byte queue between one writing thread and the drain thread
+  class Ring
+  {
+   public:
+    static constexpr size_t capacity = 1 << 22;
+
+   private:
+    std::unique_ptr<char[]> data;
+    std::atomic<size_t> head{ 0 }; // bytes written, only moved by the writer
+    std::atomic<size_t> tail{ 0 }; // bytes drained, only moved by the drain
+
+    void copy_in(size_t pos, const void* src, size_t n)
+    {
+      if (n == 0)
+        return;
+      size_t i     = pos % capacity;
+      size_t first = std::min(n, capacity - i);
+      std::memcpy(data.get() + i, src, first);
+      std::memcpy(data.get(), static_cast<const char*>(src) + first,
+                  n - first);
+    }
+
+   public:
+    Ring() : data(std::make_unique<char[]>(capacity)) {}
+
+    // blocks until there is room for n bytes. returns if it had to wait
+    bool reserve(size_t n) const
+    {
+      assert(n <= capacity);
+      size_t h  = head.load(std::memory_order_relaxed);
+      bool full = false;
+      while (capacity - (h - tail.load(std::memory_order_acquire)) < n)
+      {
+        full = true;
+        std::this_thread::yield();
+      }
+      return full;
+    }
+
+    // publishes a record of two parts at once, after reserve()
+    void push(const void* first, size_t n_first, const void* second,
+              size_t n_second)
+    {
+      size_t h = head.load(std::memory_order_relaxed);
+      copy_in(h, first, n_first);
+      copy_in(h + n_first, second, n_second);
+      head.store(h + n_first + n_second, std::memory_order_release);
+    }
+
+    // writes all published records to out
+    void drain(std::ostream& out)
+    {
+      size_t h = head.load(std::memory_order_acquire);
+      size_t t = tail.load(std::memory_order_relaxed);
+      if (h == t)
+        return;
+
+      size_t i     = t % capacity;
+      size_t first = std::min(h - t, capacity - i);
+      out.write(data.get() + i, first);
+      out.write(data.get(), h - t - first);
+      tail.store(h, std::memory_order_release);
+    }
+  };
+
+  // writes binary event records to a file without formatting or flushing on
+  // the calling thread. every thread gets its own ring buffer, which a
+  // background thread drains every millisecond. decode with trace-decode
+  class Tracer
+  {
+   private:
+    const ExpressionCache& lits;
+    std::ofstream file;
+    const uint64_t id;
+    std::chrono::steady_clock::time_point start;
+
+    std::mutex rings_mutex;
+    std::vector<std::unique_ptr<Ring>> rings;
+    std::atomic<bool> running{ true };
+    std::thread drainer;
+    std::atomic<uint64_t> stalls{ 0 };
+
+    static uint64_t next_id()
+    {
+      static std::atomic<uint64_t> count{ 0 };
+      return ++count;
+    }
+
+    Ring& local_ring()
+    {
+      // the ring of this thread, for the tracer with id owner
+      thread_local uint64_t owner = 0;
+      thread_local Ring* ring     = nullptr;
+      if (owner != id)
+      {
+        std::lock_guard<std::mutex> lock(rings_mutex);
+        rings.push_back(std::make_unique<Ring>());
+        ring  = rings.back().get();
+        owner = id;
+      }
+      return *ring;
+    }
+
+    void drain_all()
+    {
+      std::lock_guard<std::mutex> lock(rings_mutex);
+      for (auto& r : rings)
+        r->drain(file);
+    }
+
+    void write_header()
+    {
+      using namespace std::chrono;
+      Header h{};
+      h.magic   = magic;
+      h.version = version;
+      h.start_ns =
+          duration_cast<nanoseconds>(system_clock::now().time_since_epoch())
+              .count();
+      h.n_vars = lits.size();
+      file.write(reinterpret_cast<const char*>(&h), sizeof(h));
+
+      for (const z3::expr& e : lits.currents())
+      {
+        std::string name = e.to_string();
+        uint32_t length  = name.size();
+        file.write(reinterpret_cast<const char*>(&length), sizeof(length));
+        file.write(name.data(), length);
+      }
+    }
+
+    // the literal of e, marked if it is in the next state
+    uint32_t encode(const z3::expr& e) const
+    {
+      if (lits.literal_is_current(e))
+        return lits.to_lit(e);
+      if (lits.literal_is_p(e))
+        return lits.to_lit_p(e) | primed;
+      return no_lit;
+    }
+
+   public:
+    Tracer(const std::string& filename, const ExpressionCache& l)
+        : lits(l), file(filename, std::ios::binary | std::ios::trunc),
+          id(next_id()), start(std::chrono::steady_clock::now())
+    {
+      if (!file.is_open())
+        throw std::runtime_error("Failed to open " + filename);
+      write_header();
+
+      drainer = std::thread(
+          [this]()
+          {
+            while (running.load(std::memory_order_relaxed))
+            {
+              std::this_thread::sleep_for(std::chrono::milliseconds(1));
+              drain_all();
+            }
+          });
+    }
+
+    ~Tracer()
+    {
+      running = false;
+      drainer.join();
+      drain_all();
+    }
+
+    Tracer(const Tracer&)            = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+    void emit(unsigned indent, Event e, double a = 0, double b = 0,
+              LitSpan cube = {})
+    {
+      RecordHead r{};
+      r.time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+      r.event  = static_cast<uint16_t>(e);
+      r.indent = indent;
+      r.n_lits = cube.size();
+      r.a      = a;
+      r.b      = b;
+
+      Ring& ring       = local_ring();
+      size_t lit_bytes = cube.size() * sizeof(Lit);
+      if (ring.reserve(sizeof(r) + lit_bytes))
+        stalls++;
+      ring.push(&r, sizeof(r), cube.begin(), lit_bytes);
+    }
+
+    void emit(unsigned indent, Event e, double a, double b,
+              const z3::expr_vector& cube)
+    {
+      Cube encoded;
+      for (const z3::expr& lit : cube)
+        encoded.push_back(encode(lit));
+      emit(indent, e, a, b, encoded);
+    }
+
+    // times a record had to wait for the drain thread
+    uint64_t n_stalls() const { return stalls.load(); }
+  };
+} // namespace pdr::trace
+#endif // PDR_TRACER_H
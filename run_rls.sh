@@ -20,17 +20,13 @@ for file in $BENCHMARKS/$SUBF/*; do
 		if [ "$extension" = "tfc" ]; then
 			echo -e "${bold}============\n============\n============\n"
 			echo -e "Running pdr for $filename\n\n"
-			if [ -z $SUBF ]; then
-				ARGS=""
-			else
-				ARGS="-b $SUBF"
-			fi
-			command="$EXEC -d $filename 100 $ARGS"
+			ARGS="--dir $BENCHMARKS/$SUBF --tfc $filename -p 100"
+			command="$EXEC -d $ARGS"
 
 			echo "${bold}$command${normal}"
 			$command
 			echo -e "\n\n"
-			command2="$EXEC -do $filename 100 $ARGS"
+			command2="$EXEC -d -o $ARGS"
 			echo "${bold}$command2${normal}"
 			$command2
 		fi
@@ -1,25 +1,36 @@
 #include "pdr.h"
 #include <bits/types/FILE.h>
 #include <cstddef>
+#include <fmt/format.h>
 #include <string>
 
 namespace pdr
 {
-  bool PDR::decrement(bool reuse)
+  template <typename Policy>
+  bool PDR<Policy>::decrement(bool reuse)
   {
     int max_pebbles = model.get_max_pebbles();
     int new_pebbles = shortest_strategy - 1;
     assert(new_pebbles > 0);
     assert(new_pebbles < max_pebbles);
 
-    if (!model.set_max_pebbles(new_pebbles))
-      return false;
-
+    bool feasible = model.set_max_pebbles(new_pebbles);
     reset();
     results.extend();
-    logger.whisper() << "retrying with " << new_pebbles << std::endl;
-    if (!reuse)
+
+    if (!feasible)
+    {
+      // no strategy exists below the structural lower bound, skip pdr
+      log_and_show(fmt::format("No strategy for {} pebbles. Lower bound: {}",
+                               new_pebbles, model.get_lower_bound().str()));
       return true;
+    }
+
+    PDR_WHISPER(logger, "retrying with {}", new_pebbles);
+    if (!reuse)
+      return false;
+
+    reachable.restrict();
 
     // TODO separate staistics from dyn runs?
     frames.reset_frames(logger.stats,
@@ -36,4 +47,7 @@ namespace pdr
     }
     return false;
   }
+
+  template bool PDR<FatPolicy>::decrement(bool);
+  template bool PDR<DeltaPolicy>::decrement(bool);
 } // namespace pdr
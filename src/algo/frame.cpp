@@ -18,7 +18,8 @@ namespace pdr
 
   Frame::Frame(unsigned i, z3::context& c,
                const std::vector<z3::expr_vector>& assertions, Logger& l)
-      : level(i), logger(l), solver(std::make_unique<Solver>(c, assertions))
+      : level(i), logger(l),
+        solver(std::make_unique<Solver>(c, assertions, l.query_log.get()))
   {
   }
 
@@ -30,8 +31,8 @@ namespace pdr
     {
       if (z3ext::subsumes(blocked_cube, cube))
       {
-        SPDLOG_LOGGER_TRACE(logger.spd_logger, "already blocked in F{} by {}",
-                            level, z3ext::join_expr_vec(blocked_cube));
+        PDR_TRACE(logger, trace::Event::already_blocked, level, 0,
+                  blocked_cube);
         return true; // equal or stronger clause found
       }
     }
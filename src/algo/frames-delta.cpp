@@ -0,0 +1,139 @@
+#include "frames.h"
+#include "_logging.h"
+#include "frame.h"
+#include "solver.h"
+#include "z3-ext.h"
+
+#include <cassert>
+#include <chrono>
+#include <fmt/format.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include <z3++.h>
+
+// delta encoding: one solver for F_1.., with act_i guarding the cubes of F_i
+namespace pdr
+{
+  template <> void Frames<DeltaPolicy>::init_encoding()
+  {
+    encoding.solver =
+        std::make_unique<Solver>(ctx, base_assertions, logger.query_log.get());
+    encoding.act.push_back(ctx.bool_const("__actI__")); // unused
+  }
+
+  template <> void Frames<DeltaPolicy>::extend()
+  {
+    assert(frames.size() > 0);
+    std::string acti = fmt::format("__act{}__", frames.size());
+    encoding.act.push_back(ctx.bool_const(acti.c_str()));
+    frames.push_back(std::make_unique<Frame>(frames.size(), logger));
+  }
+
+  template <> void Frames<DeltaPolicy>::set_frame_base()
+  {
+    encoding.solver->base_assertions = base_assertions;
+  }
+
+  // reset the solver and repopulate with current blocked cubes
+  template <> void Frames<DeltaPolicy>::clean_solvers()
+  {
+    PDR_PROFILE(logger, "clean_solvers");
+    encoding.solver->reset();
+    for (size_t i = 1; i < frames.size(); i++)
+      for (const z3::expr_vector& cube : frames[i]->get_blocked())
+        encoding.solver->block(cube, encoding.act.at(i));
+  }
+
+  // a cube is only stored in the last frame it holds
+  template <>
+  bool Frames<DeltaPolicy>::block_in_frames(const z3::expr_vector& cube,
+                                            size_t level)
+  {
+    for (unsigned i = 1; i <= level; i++)
+    {
+      // remove all blocked cubes that are equal or weaker than cube
+      unsigned n_removed = frames.at(i)->remove_subsumed(cube);
+      logger.stats.subsumed_cubes.add(level, n_removed);
+    }
+
+    assert(level > 0);
+    if (frames.at(level)->block(cube))
+    {
+      encoding.solver->block(cube, encoding.act.at(level));
+      PDR_TRACE(logger, trace::Event::blocked_in, level);
+      return true;
+    }
+    return false;
+  }
+
+  template <>
+  int Frames<DeltaPolicy>::push_forward(unsigned level, bool repeat)
+  {
+    using std::chrono::steady_clock;
+    auto start = steady_clock::now();
+
+    CubeSet blocked = frames.at(level)->get_blocked();
+    for (const z3::expr_vector& cube : blocked)
+    {
+      if (!trans_from_to(level, cube, Query::propagation))
+      {
+        if (remove_state(cube, level + 1))
+          if (repeat)
+            PDR_OUT(logger, "new blocked in repeat");
+      }
+    }
+
+    std::chrono::duration<double> dt(steady_clock::now() - start);
+    logger.stats.propagation_level.add_timed(level, dt.count());
+    return -1;
+  }
+
+  // F_i \ F_i+1 is stored in frame i, it may be emptied by later pushes
+  template <> int Frames<DeltaPolicy>::converged(unsigned level) const
+  {
+    for (unsigned i = 1; i <= level; i++)
+    {
+      if (frames.at(i)->empty())
+      {
+        PDR_OUT(logger, "F[{}] \\ F[{}] == 0", i, i + 1);
+        return i;
+      }
+    }
+    return -1;
+  }
+
+  template <> void Frames<DeltaPolicy>::add_to_frames(const z3::expr& clause)
+  {
+    encoding.solver->add(clause);
+  }
+
+  template <> Solver* Frames<DeltaPolicy>::frame_solver(size_t frame) const
+  {
+    if (frame > 0)
+      return encoding.solver.get();
+    return frames.at(frame)->get_solver();
+  }
+
+  template <> void Frames<DeltaPolicy>::activate(size_t frame) const
+  {
+    if (frame == 0)
+      return;
+
+    assert(frames.size() == encoding.act.size());
+    for (unsigned i = frame; i <= frontier(); i++)
+      assumption_buffer.push_back(encoding.act[i]);
+  }
+
+  template <>
+  void Frames<DeltaPolicy>::encoding_statistics(Statistics& s) const
+  {
+    s.delta_solver = encoding.solver->statistics();
+  }
+
+  template <>
+  std::vector<z3::expr_vector> Frames<DeltaPolicy>::solver_lemmas() const
+  {
+    return { encoding.solver->lemmas() };
+  }
+} // namespace pdr
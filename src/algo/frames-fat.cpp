@@ -0,0 +1,121 @@
+#include "frames.h"
+#include "_logging.h"
+#include "frame.h"
+#include "solver.h"
+#include "z3-ext.h"
+
+#include <cassert>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include <z3++.h>
+
+// fat encoding: every frame has its own solver
+namespace pdr
+{
+  template <> void Frames<FatPolicy>::init_encoding() {}
+
+  template <> void Frames<FatPolicy>::extend()
+  {
+    assert(frames.size() > 0);
+    frames.push_back(
+        std::make_unique<Frame>(frames.size(), ctx, base_assertions, logger));
+  }
+
+  template <> void Frames<FatPolicy>::set_frame_base()
+  {
+    for (size_t i = 1; i < frames.size(); i++)
+      frames[i]->get_solver()->base_assertions = base_assertions;
+  }
+
+  // reset solvers and repopulate with current blocked cubes
+  template <> void Frames<FatPolicy>::clean_solvers()
+  {
+    PDR_PROFILE(logger, "clean_solvers");
+    for (size_t i = 1; i < frames.size(); i++)
+      frames[i]->get_solver()->reset(frames[i]->get_blocked());
+  }
+
+  template <>
+  bool Frames<FatPolicy>::block_in_frames(const z3::expr_vector& cube,
+                                          size_t level)
+  {
+    assert(level > 0);
+    for (unsigned i = 1; i <= level; i++)
+    {
+      // remove all blocked cubes that are equal or weaker than cube
+      unsigned n_removed = frames.at(i)->remove_subsumed(cube);
+      logger.stats.subsumed_cubes.add(level, n_removed);
+
+      if (frames.at(i)->block(cube))
+      {
+        frames.at(i)->block_in_solver(cube);
+        PDR_TRACE(logger, trace::Event::blocked_in, i);
+      }
+      else
+        return false;
+    }
+    return true;
+  }
+
+  template <> int Frames<FatPolicy>::push_forward(unsigned level, bool repeat)
+  {
+    int rv = -1;
+    using std::chrono::steady_clock;
+    auto start = steady_clock::now();
+
+    std::vector<z3::expr_vector> diff =
+        frames.at(level)->diff(*frames.at(level + 1));
+    for (const z3::expr_vector& cube : diff)
+    {
+      if (!trans_from_to(level, cube, Query::propagation))
+      {
+        if (remove_state(cube, level + 1))
+          if (repeat)
+            PDR_OUT(logger, "new blocked in repeat");
+      }
+    }
+
+    if (diff.size() == 0 || frames.at(level)->equals(*frames.at(level + 1)))
+    {
+      PDR_OUT(logger, "F_{} \\ F_{} == 0", level, level + 1);
+      rv = level;
+    }
+
+    std::chrono::duration<double> dt(steady_clock::now() - start);
+    logger.stats.propagation_level.add_timed(level, dt.count());
+    return rv;
+  }
+
+  // equal frames are found while pushing
+  template <> int Frames<FatPolicy>::converged(unsigned) const { return -1; }
+
+  template <> void Frames<FatPolicy>::add_to_frames(const z3::expr& clause)
+  {
+    for (size_t i = 1; i < frames.size(); i++)
+      frames[i]->get_solver()->add(clause);
+  }
+
+  template <> Solver* Frames<FatPolicy>::frame_solver(size_t frame) const
+  {
+    return frames.at(frame)->get_solver();
+  }
+
+  template <> void Frames<FatPolicy>::activate(size_t) const {}
+
+  // every frame solver is counted by solver_statistics
+  template <>
+  void Frames<FatPolicy>::encoding_statistics(Statistics&) const
+  {
+  }
+
+  template <>
+  std::vector<z3::expr_vector> Frames<FatPolicy>::solver_lemmas() const
+  {
+    std::vector<z3::expr_vector> rv;
+    for (auto& f : frames)
+      rv.push_back(f->get_solver()->lemmas());
+    return rv;
+  }
+} // namespace pdr
@@ -17,245 +17,205 @@
 
 namespace pdr
 {
-  Frames::Frames(bool d, z3::context& c, const PDRModel& m, Logger& l)
-      : delta(d), ctx(c), model(m), logger(l), init_solver(ctx)
+  template <typename Policy>
+  Frames<Policy>::Frames(z3::context& c, const PDRModel& m, Logger& l)
+      : ctx(c), model(m), logger(l), inf_clauses(ctx)
   {
-    init_solver.add(model.get_initial());
+    init_solver = std::make_unique<Solver>(
+        ctx, std::vector<z3::expr_vector>{ model.get_initial() },
+        logger.query_log.get());
     base_assertions.push_back(model.property.currents());
     base_assertions.push_back(model.get_transition());
     base_assertions.push_back(model.get_cardinality());
+    base_assertions.push_back(inf_clauses);
 
-    if (delta)
-      delta_solver = std::make_unique<Solver>(ctx, base_assertions);
+    inf_solver = std::make_unique<Solver>(
+        ctx,
+        std::vector<z3::expr_vector>{ model.get_transition(),
+                                      model.get_cardinality(), inf_clauses },
+        logger.query_log.get());
 
     std::vector<z3::expr_vector> initial_assertions = {
-        model.get_initial(), model.get_transition(), model.get_cardinality()};
-    act.push_back(ctx.bool_const("__actI__")); // unused
+        model.get_initial(), model.get_transition(), model.get_cardinality(),
+        inf_clauses};
     frames.push_back(std::make_unique<Frame>(frames.size(), ctx,
                                              initial_assertions, logger));
+    init_encoding();
   }
 
   // frame interface
   //
 
-  void Frames::extend()
-  {
-    assert(frames.size() > 0);
-    if (delta)
-    {
-      std::string acti = fmt::format("__act{}__", frames.size());
-      act.push_back(ctx.bool_const(acti.c_str()));
-      frames.push_back(std::make_unique<Frame>(frames.size(), logger));
-    }
-    else
-      frames.push_back(
-          std::make_unique<Frame>(frames.size(), ctx, base_assertions, logger));
-  }
-
   // prepare frames for a new run:
   // - possibly define new statistics
   // - provide new {property, transition, cardinality} to the solvers
   // then clean all solvers from old assertions
-  void Frames::reset_frames(Statistics& s,
-                            const std::vector<z3::expr_vector>& assertions)
+  // F_inf is kept: a smaller cardinality only shrinks the reachable states
+  template <typename Policy>
+  void Frames<Policy>::reset_frames(
+      Statistics& s, const std::vector<z3::expr_vector>& assertions)
   {
-    if (delta)
-      delta_solver->base_assertions = assertions;
+    base_assertions = assertions;
+    base_assertions.push_back(inf_clauses);
+    set_frame_base();
+
+    Solver* init_frame = frames.at(0)->get_solver();
+    init_frame->base_assertions = { model.get_initial(),
+                                    model.get_transition(),
+                                    model.get_cardinality(), inf_clauses };
+    init_frame->reset();
+
+    inf_solver->base_assertions = { model.get_transition(),
+                                    model.get_cardinality(), inf_clauses };
+    inf_solver->reset();
+    // a smaller cardinality removes transitions, earlier failures may pass
+    inf_tried.clear();
 
     for (size_t i = 1; i < frames.size(); i++)
-    {
       frames[i]->set_stats(s);
-      if (!delta)
-        solver(i)->base_assertions = assertions;
-    }
 
+    TimelineSpan span(logger.timeline, "clean_solvers");
     clean_solvers();
   }
 
-  // reset solvers and repopulate with current blocked cubes
-  void Frames::clean_solvers()
-  {
-    for (size_t i = 1; i < frames.size(); i++)
-    {
-      auto& f = frames[i];
-
-      if (delta)
-      {
-        if (i == 1)
-          delta_solver->reset();
-        for (const z3::expr_vector& cube : f->get_blocked())
-          delta_solver->block(cube, act.at(i));
-      }
-      else
-      {
-        solver(i)->reset(f->get_blocked());
-      }
-    }
-  }
-
-  bool Frames::remove_state(const z3::expr_vector& cube, size_t level)
+  template <typename Policy>
+  bool Frames<Policy>::remove_state(const z3::expr_vector& cube, size_t level)
   {
     level = std::min(level, frames.size() - 1);
-    SPDLOG_LOGGER_TRACE(logger.spd_logger,
-                        "{}| removing cube from level [1..{}]: [{}]",
-                        logger.tab(), level, str::extend::join(cube));
+    PDR_TRACE(logger, trace::Event::remove, level, 0, cube);
     logger.indent++;
 
-    bool result;
-    if (delta) // a cube is only stored in the last frame it holds
-      result = delta_remove_state(cube, level);
-    else
-      result = fat_remove_state(cube, level);
+    bool result = block_in_frames(cube, level);
     logger.indent--;
     return result;
   }
 
-  bool Frames::delta_remove_state(const z3::expr_vector& cube, size_t level)
-  {
-    for (unsigned i = 1; i <= level; i++)
-    {
-      // remove all blocked cubes that are equal or weaker than cube
-      unsigned n_removed = frames.at(i)->remove_subsumed(cube);
-      logger.stats.subsumed_cubes.add(level, n_removed);
-    }
-
-    assert(level > 0);
-    if (frames.at(level)->block(cube))
-    {
-      delta_solver->block(cube, act.at(level));
-      SPDLOG_LOGGER_TRACE(logger.spd_logger, "{}| blocked in {}", logger.tab(),
-                          level);
-      return true;
-    }
-    return false;
-  }
-
-  bool Frames::fat_remove_state(const z3::expr_vector& cube, size_t level)
-  {
-    assert(level > 0);
-    for (unsigned i = 1; i <= level; i++)
-    {
-      // remove all blocked cubes that are equal or weaker than cube
-      unsigned n_removed = frames.at(i)->remove_subsumed(cube);
-      logger.stats.subsumed_cubes.add(level, n_removed);
-
-      if (frames.at(i)->block(cube))
-      {
-        frames.at(i)->block_in_solver(cube);
-        SPDLOG_LOGGER_TRACE(logger.spd_logger, "{}| blocked in {}",
-                            logger.tab(), i);
-      }
-      else
-        return false;
-    }
-    return true;
-  }
-
-  int Frames::propagate(unsigned level, bool repeat)
+  template <typename Policy>
+  int Frames<Policy>::propagate(unsigned level, bool repeat)
   {
+    PDR_PROFILE(logger, "propagate");
+    TimelineSpan span(logger.timeline, "propagate", { { "level", level } });
     assert(level == frontier() - 1); // k == |F|-1
-    logger.out() << "propagate level " << level << std::endl;
-    SPDLOG_LOGGER_TRACE(logger.spd_logger, "{}| propagate frame {} to {}",
-                        logger.tab(), 1, level);
+    PDR_OUT(logger, "propagate level {}", level);
+    PDR_TRACE(logger, trace::Event::propagate, 1, level);
     logger.indent++;
 
     for (unsigned i = 1; i <= level; i++)
     {
-      if (delta)
-        push_forward_delta(i, repeat);
-      else if (push_forward_fat(i, repeat))
+      TimelineSpan push_span(logger.timeline, "push_forward",
+                             { { "level", i } });
+      if (push_forward(i, repeat) >= 0)
         return i;
     }
 
-    if (delta)
-      for (unsigned i = 1; i <= level; i++)
-      {
-        if (frames.at(i)->empty())
-        {
-          logger.out() << fmt::format("F[{}] \\ F[{}] == 0", i, i + 1)
-                    << std::endl;
-          return i;
-        }
-      }
+    unsigned n_promoted = promote_to_inf();
+    if (n_promoted > 0)
+      PDR_OUT(logger, "{} lemmas moved to F_inf", n_promoted);
 
-    clean_solvers();
+    int fixpoint = converged(level);
+    if (fixpoint >= 0)
+      return fixpoint;
+
+    {
+      TimelineSpan reset_span(logger.timeline, "clean_solvers");
+      clean_solvers();
+    }
     logger.indent--;
 
     return -1;
   }
 
-  void Frames::push_forward_delta(unsigned level, bool repeat)
+  //
+  // end frame interface
+
+  // F_inf interface
+  //
+  // query: F_inf & !s & T /=> !s'
+  template <typename Policy>
+  bool Frames<Policy>::inf_inductive(const z3::expr_vector& cube,
+                                     Query q) const
   {
+    PDR_PROFILE(logger, "SAT F_inf");
     using std::chrono::steady_clock;
     auto start = steady_clock::now();
 
-    CubeSet blocked = frames.at(level)->get_blocked();
-    for (const z3::expr_vector& cube : blocked)
-    {
-      if (!trans_from_to(level, cube))
-      {
-        if (remove_state(cube, level + 1))
-          if (repeat)
-            logger.out() << "new blocked in repeat" << std::endl;
-      }
-    }
+    z3::expr clause = z3::mk_or(z3ext::negate(cube));
+    z3::expr_vector assumptions = model.literals.p(cube);
+    assumptions.push_back(clause);
+    bool result = !inf_solver->SAT(assumptions);
 
-    std::chrono::duration<double> dt(steady_clock::now() - start);
-    logger.stats.propagation_level.add_timed(level, dt.count());
+    std::chrono::duration<double> diff(steady_clock::now() - start);
+    logger.stats.solver_calls.add_timed(frontier(), diff.count());
+    logger.stats.add_query(q, !result, diff.count());
+    return result;
   }
 
-  int Frames::push_forward_fat(unsigned level, bool repeat)
+  template <typename Policy>
+  bool Frames<Policy>::block_inf(const z3::expr_vector& cube)
   {
-    int rv = -1;
-    using std::chrono::steady_clock;
-    auto start = steady_clock::now();
+    if (!inf_cubes.insert(cube).second)
+      return false;
 
-    std::vector<z3::expr_vector> diff =
-        frames.at(level)->diff(*frames.at(level + 1));
-    for (const z3::expr_vector& cube : diff)
-    {
-      if (!trans_from_to(level, cube))
-      {
-        if (remove_state(cube, level + 1))
-          if (repeat)
-            logger.out() << "new blocked in repeat" << std::endl;
-      }
-    }
+    PDR_TRACE(logger, trace::Event::blocked_inf, 0, 0, cube);
+    // solvers pick up inf_clauses on their next reset, add it to live ones
+    z3::expr clause = z3::mk_or(z3ext::negate(cube));
+    inf_clauses.push_back(clause);
+    inf_solver->add(clause);
+    frames.at(0)->get_solver()->add(clause);
+    add_to_frames(clause);
+
+    return true;
+  }
 
-    if (diff.size() == 0 || frames.at(level)->equals(*frames.at(level + 1)))
+  // a lemma that is inductive without the frames holds in all reachable
+  // states. it also remains valid for any smaller cardinality, as this only
+  // removes transitions
+  template <typename Policy>
+  unsigned Frames<Policy>::promote_to_inf()
+  {
+    // a lemma stays in the frontier while propagation extends the frames,
+    // check each once. collected first, promoting removes subsumed cubes
+    std::vector<z3::expr_vector> candidates;
+    for (const z3::expr_vector& cube : frames.back()->get_blocked())
+      if (inf_tried.insert(cube).second)
+        candidates.push_back(cube);
+
+    unsigned n_promoted = 0;
+    for (const z3::expr_vector& cube : candidates)
     {
-      logger.out() << fmt::format("F_{} \\ F_{} == 0", level, level + 1)
-                << std::endl;
-      rv = level;
+      if (!inf_inductive(cube, Query::propagation))
+        continue;
+
+      for (size_t i = 1; i < frames.size(); i++)
+        frames[i]->remove_subsumed(cube);
+      if (block_inf(cube))
+        n_promoted++;
     }
 
-    std::chrono::duration<double> dt(steady_clock::now() - start);
-    logger.stats.propagation_level.add_timed(level, dt.count());
-    return rv;
+    logger.stats.inf_lemmas.add(frontier(), n_promoted);
+    return n_promoted;
   }
+
+  template <typename Policy>
+  const CubeSet& Frames<Policy>::get_inf() const { return inf_cubes; }
   //
-  // end frame interface
+  // end F_inf interface
 
   // queries
   //
-  bool Frames::inductive(const std::vector<z3::expr>& cube, size_t frame) const
-  {
-    return inductive(z3ext::convert(cube), frame);
-  }
-
   // verifies if !cube is inductive relative to F_[frame]
   // query: Fi & !s & T /=> !s'
-  bool Frames::inductive(const z3::expr_vector& cube, size_t frame) const
+  template <typename Policy>
+  bool Frames<Policy>::inductive(const z3::expr_vector& cube, size_t frame,
+                                 Query q) const
   {
-    SPDLOG_LOGGER_TRACE(logger.spd_logger,
-                        "{}| check relative inductiveness, frame {}",
-                        logger.tab(), frame);
+    PDR_TRACE(logger, trace::Event::inductive, frame);
     z3::expr clause =
         z3::mk_or(z3ext::negate(cube)); // negate cube via demorgan
     z3::expr_vector assumptions = model.literals.p(cube); // cube in next state
     assumptions.push_back(clause);
 
-    if (SAT(frame, std::move(assumptions)))
+    if (SAT(frame, std::move(assumptions), q))
     { // there is a transition from !s to s'
       return false;
     }
@@ -263,48 +223,68 @@ namespace pdr
     return true;
   }
 
-  Witness Frames::counter_to_inductiveness(const std::vector<z3::expr>& cube,
-                                           size_t frame) const
+  // if primed: cube is already in next state, else first convert it
+  template <typename Policy>
+  bool Frames<Policy>::trans_from_to(size_t frame,
+                                     const z3::expr_vector& cube, Query q,
+                                     bool primed) const
   {
-    SPDLOG_LOGGER_TRACE(logger.spd_logger,
-                        "{}| counter to relative inductiveness, frame {}",
-                        logger.tab(), frame);
-    if (!inductive(cube, frame))
-      return std::make_unique<z3::model>(get_model(frame));
+    PDR_TRACE(logger, trace::Event::transition, frame);
+    if (!primed) // cube is in current, bring to next
+      return SAT(frame, model.literals.p(cube), q);
+
+    return SAT(frame, cube, q); // there is a transition from Fi to s'
+  }
 
-    return std::unique_ptr<z3::model>();
+  template <typename Policy>
+  bool Frames<Policy>::inductive(LitSpan cube, size_t frame, Query q) const
+  {
+    PDR_TRACE(logger, trace::Event::inductive, frame);
+    assumption_buffer.clear();
+    for (Lit l : cube)
+      assumption_buffer.push_back(model.literals.lit(lit_neg(l)));
+    z3::expr clause(ctx, Z3_mk_or(ctx, assumption_buffer.size(),
+                                  assumption_buffer.data()));
+
+    assumption_buffer.clear();
+    for (Lit l : cube) // cube in next state
+      assumption_buffer.push_back(model.literals.lit(l, true));
+    assumption_buffer.push_back(clause);
+
+    return !SAT_buffer(frame, q);
   }
 
-  Witness Frames::counter_to_inductiveness(const z3::expr_vector& cube,
-                                           size_t frame) const
+  template <typename Policy>
+  bool Frames<Policy>::trans_from_to(size_t frame, LitSpan cube,
+                                     Query q) const
   {
-    if (!inductive(cube, frame))
-      return std::make_unique<z3::model>(get_model(frame));
+    PDR_TRACE(logger, trace::Event::transition, frame);
+    assumption_buffer.clear();
+    for (Lit l : cube)
+      assumption_buffer.push_back(model.literals.lit(l, true));
 
-    return std::unique_ptr<z3::model>();
+    return SAT_buffer(frame, q);
   }
 
-  // if primed: cube is already in next state, else first convert it
-  bool Frames::trans_from_to(size_t frame, const z3::expr_vector& cube,
-                             bool primed) const
+  template <typename Policy>
+  bool Frames<Policy>::init_intersects(LitSpan cube, Query q) const
   {
-    SPDLOG_LOGGER_TRACE(logger.spd_logger, "{}| transition check, frame {}",
-                        logger.tab(), frame);
-    if (!primed) // cube is in current, bring to next
-      return SAT(frame, model.literals.p(cube));
+    assumption_buffer.clear();
+    for (Lit l : cube)
+      assumption_buffer.push_back(model.literals.lit(l));
 
-    return SAT(frame, cube); // there is a transition from Fi to s'
+    return init_SAT_buffer(q);
   }
 
-  Witness Frames::get_trans_from_to(size_t frame, const z3::expr_vector& cube,
-                                    bool primed) const
+  template <typename Policy>
+  bool Frames<Policy>::init_intersects(const z3::expr_vector& cube,
+                                       Query q) const
   {
-    SPDLOG_LOGGER_TRACE(logger.spd_logger, "{}| transition query, frame {}",
-                        logger.tab(), frame);
-    if (!primed) // cube is in current, bring to next
-      return SAT_model(frame, model.literals.p(cube));
+    assumption_buffer.clear();
+    for (const z3::expr& e : cube)
+      assumption_buffer.push_back(e);
 
-    return SAT_model(frame, cube); // there is a transition from Fi to s'
+    return init_SAT_buffer(q);
   }
 
   //
@@ -312,68 +292,74 @@ namespace pdr
 
   // SAT interface
   //
-  bool Frames::SAT(size_t frame, const z3::expr_vector& assumptions) const
+  template <typename Policy>
+  bool Frames<Policy>::SAT(size_t frame, const z3::expr_vector& assumptions,
+                           Query q) const
   {
-    return SAT(frame, z3ext::copy(assumptions));
+    PDR_TRACE(logger, trace::Event::assumptions, 0, 0, assumptions);
+
+    assumption_buffer.clear();
+    for (const z3::expr& e : assumptions)
+      assumption_buffer.push_back(e);
+    return SAT_buffer(frame, q);
   }
 
-  // the expr_vector assumptions are modified by acts,
-  // and should be considered usable afterwards
-  bool Frames::SAT(size_t frame, z3::expr_vector&& assumptions) const
+  // SAT over the assumptions in assumption_buffer
+  template <typename Policy>
+  bool Frames<Policy>::SAT_buffer(size_t frame, Query q) const
   {
+    PDR_PROFILE(logger, "SAT");
     using std::chrono::steady_clock;
     auto start = steady_clock::now();
 
-    Solver* solver = nullptr;
-    if (delta && frame > 0)
-    {
-      SPDLOG_LOGGER_TRACE(logger.spd_logger, "{}| Delta check", logger.tab());
+    PDR_TRACE(logger, frame > 0 ? Policy::check : trace::Event::check_init);
+    activate(frame);
+    Solver* solver = frame_solver(frame);
+    bool result =
+        solver->SAT(assumption_buffer.data(), assumption_buffer.size());
+    std::chrono::duration<double> diff(steady_clock::now() - start);
+    logger.stats.solver_calls.add_timed(frontier(), diff.count());
+    logger.stats.add_query(q, result, diff.count());
+    count_vectors();
 
-      assert(frames.size() == act.size());
-      for (unsigned i = frame; i <= frontier(); i++)
-        assumptions.push_back(act.at(i));
+    return result;
+  }
 
-      solver = delta_solver.get();
-    }
-    else
-    {
-      SPDLOG_LOGGER_TRACE(logger.spd_logger, "{}| Fat check", logger.tab());
-      solver = frames.at(frame)->get_solver();
-    }
+  // I & assumption_buffer
+  template <typename Policy>
+  bool Frames<Policy>::init_SAT_buffer(Query q) const
+  {
+    PDR_PROFILE(logger, "SAT I");
+    using std::chrono::steady_clock;
+    auto start = steady_clock::now();
 
-    logger.indent++;
-    SPDLOG_LOGGER_TRACE(logger.spd_logger, "{}| assumps: [ {} ]", logger.tab(),
-                        z3ext::join_expr_vec(assumptions, false));
-    logger.indent--;
+    bool result =
+        init_solver->SAT(assumption_buffer.data(), assumption_buffer.size());
 
-    bool result = solver->SAT(assumptions);
     std::chrono::duration<double> diff(steady_clock::now() - start);
-    logger.stats.solver_calls.add_timed(frontier(), diff.count());
-
+    logger.stats.add_query(q, result, diff.count());
     return result;
   }
 
-  Witness Frames::SAT_model(size_t frame,
-                            const z3::expr_vector& assumptions) const
+  // attribute the vectors built since the last query to this one
+  template <typename Policy>
+  void Frames<Policy>::count_vectors() const
   {
-    if (SAT(frame, assumptions))
-      return std::make_unique<z3::model>(get_model(frame));
-    return std::unique_ptr<z3::model>();
+    logger.stats.query_vectors.add(frontier(),
+                                   z3ext::vectors_built - vectors_mark);
+    vectors_mark = z3ext::vectors_built;
   }
 
-  Witness Frames::SAT_model(size_t frame, z3::expr_vector&& assumptions) const
+  template <typename Policy>
+  const z3::model Frames<Policy>::get_model(size_t frame) const
   {
-    if (SAT(frame, assumptions))
-      return std::make_unique<z3::model>(get_model(frame));
-    return std::unique_ptr<z3::model>();
+    return frame_solver(frame)->get_model();
   }
 
-  const z3::model Frames::get_model(size_t frame) const
+  template <typename Policy>
+  LitSpan Frames<Policy>::witness_current(size_t frame) const
   {
-    if (delta && frame > 0)
-      return delta_solver->get_model();
-    else
-      return frames.at(frame)->get_solver()->get_model();
+    return frame_solver(frame)->witness(model.literals.vars());
   }
 
   //
@@ -381,62 +367,131 @@ namespace pdr
 
   // getters
   //
-  unsigned Frames::frontier() const
+  template <typename Policy>
+  unsigned Frames<Policy>::frontier() const
   {
     assert(frames.size() > 0);
     return frames.size() - 1;
   }
 
-  Solver* Frames::solver(size_t frame)
-  {
-    if (delta && frame > 0)
-      return delta_solver.get();
-    return frames.at(frame)->get_solver();
-  }
+  template <typename Policy>
+  Solver* Frames<Policy>::solver(size_t frame) { return frame_solver(frame); }
 
-  const Frame& Frames::operator[](size_t i) { return *frames.at(i); }
+  template <typename Policy>
+  const Frame& Frames<Policy>::operator[](size_t i) { return *frames.at(i); }
 
   //
   // end getters
 
-  void Frames::log_solvers() const
+  template <typename Policy>
+  void Frames<Policy>::solver_statistics(Statistics& s) const
+  {
+    s.frame_solvers.clear();
+    s.frame_lemmas.clear();
+    for (auto& f : frames)
+    {
+      s.frame_lemmas.push_back(f->get_blocked().size());
+      if (Solver* solver = f->get_solver())
+        s.frame_solvers.push_back(solver->statistics());
+    }
+    s.inf_solver = inf_solver->statistics();
+    encoding_statistics(s);
+  }
+
+  template <typename Policy>
+  void Frames<Policy>::dump(std::ostream& out) const
   {
-    SPDLOG_LOGGER_TRACE(logger.spd_logger, SEP3);
-    if (delta)
-      SPDLOG_LOGGER_TRACE(logger.spd_logger, "{}", delta_solver->as_str());
-    else
-      for (const std::unique_ptr<Frame>& f : frames)
+    auto dump_cubes = [this, &out](const CubeSet& cubes)
+    {
+      for (const z3::expr_vector& cube : cubes)
       {
-        SPDLOG_LOGGER_TRACE(logger.spd_logger, "{}",
-                            (*f).get_solver()->as_str());
+        for (unsigned i = 0; i < cube.size(); i++)
+          out << (i > 0 ? " " : "") << model.literals.to_lit(cube[i]);
+        out << '\n';
       }
-    SPDLOG_LOGGER_TRACE(logger.spd_logger, SEP3);
+    };
+
+    out << "# pdr frames " << model.literals.size() << '\n';
+    for (size_t i = 0; i < frames.size(); i++)
+    {
+      out << "frame " << i << '\n';
+      dump_cubes(frames[i]->get_blocked());
+    }
+    out << "inf\n";
+    dump_cubes(inf_cubes);
+    out.flush();
   }
 
-  std::string Frames::blocked_str() const
+  template <typename Policy>
+  void Frames<Policy>::trace_lemmas() const
   {
-    std::string str;
-    for (auto& f : frames)
+#ifdef LOG
+    if (!logger.tracer)
+      return;
+    for (size_t i = 1; i < frames.size(); i++)
+      for (const z3::expr_vector& cube : frames[i]->get_blocked())
+        PDR_TRACE(logger, trace::Event::lemma, i, 0, cube);
+#endif
+  }
+
+  template <typename Policy>
+  std::shared_ptr<const FramesSnapshot> Frames<Policy>::snapshot() const
+  {
+    auto rv = std::make_shared<FramesSnapshot>();
+    std::vector<z3::expr_vector> exprs = { z3::expr_vector(ctx) };
+    auto add_cubes = [&rv, &exprs](const CubeSet& cubes)
     {
-      str += f->blocked_str();
-      str += '\n';
-    }
-    return str;
+      rv->cube_sizes.emplace_back();
+      for (const z3::expr_vector& cube : cubes)
+      {
+        rv->cube_sizes.back().push_back(cube.size());
+        for (const z3::expr& l : cube)
+          exprs[0].push_back(l);
+      }
+    };
+    for (auto& f : frames)
+      add_cubes(f->get_blocked());
+    add_cubes(inf_cubes);
+    for (z3::expr_vector& lemmas : solver_lemmas())
+      exprs.push_back(std::move(lemmas));
+
+    rv->exprs = std::make_unique<ExprSnapshot>(exprs);
+    return rv;
   }
-  std::string Frames::solvers_str() const
+
+  void FramesSnapshot::show(std::ostream& out) const
   {
-    std::string str;
-    if (delta)
-      str += delta_solver->as_str();
-    else
+    const z3::expr_vector& lits = (*exprs)[0];
+    unsigned next               = 0;
+    out << "Frames" << std::endl;
+    for (size_t i = 0; i < cube_sizes.size(); i++)
     {
-      for (auto& f : frames)
+      if (i + 1 < cube_sizes.size())
+        out << "blocked cubes level " << i << '\n';
+      else
+        out << "blocked cubes level inf\n";
+      for (unsigned size : cube_sizes[i])
       {
-        str += f->get_solver()->as_str();
-        str += '\n';
+        z3::expr_vector cube(lits.ctx());
+        for (unsigned j = 0; j < size; j++)
+          cube.push_back(lits[next++]);
+        out << fmt::format("- {}\n", z3ext::join_expr_vec(cube, " & "));
       }
+      if (i + 1 < cube_sizes.size())
+        out << '\n';
+    }
+    out << std::endl << std::endl << SEP2 << std::endl;
+
+    out << "Solvers" << std::endl;
+    for (size_t i = 1; i < exprs->get().size(); i++)
+    {
+      for (const z3::expr& e : (*exprs)[i])
+        out << fmt::format("- {}\n", e.to_string());
+      out << '\n';
     }
-    return str;
+    out << std::endl;
   }
 
+  template class Frames<FatPolicy>;
+  template class Frames<DeltaPolicy>;
 } // namespace pdr
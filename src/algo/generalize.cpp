@@ -9,14 +9,25 @@
 
 namespace pdr
 {
+    namespace
+    {
+        // the order in which MIC tries to drop literals: pebbled nodes first
+        bool pebbled_first(Lit a, Lit b)
+        {
+            if (lit_sign(a) != lit_sign(b))
+                return lit_sign(a) < lit_sign(b);
+            return a < b;
+        }
+    } // namespace
+
     //! s is inductive up until min-1. !s is included up until min
-    int PDR::highest_inductive_frame(const z3::expr_vector& cube, int min,
-                                     int max)
+    template <typename Policy>
+    int PDR<Policy>::highest_inductive_frame(const z3::expr_vector& cube,
+                                             int min, int max)
     {
-        if (min <= 0 && !frames.inductive(cube, 0))
+        if (min <= 0 && !frames.inductive(cube, 0, Query::consecution))
         {
-            SPDLOG_LOGGER_TRACE(logger.spd_logger, "{}| Intersects I",
-                                logger.tab());
+            PDR_TRACE(logger, trace::Event::intersects_init);
             return -1; 
         }
 
@@ -24,22 +35,23 @@ namespace pdr
         for (int i = std::max(1, min); i <= max; i++)
         {
             // clause was inductive up to this iteration
-            if (!frames.inductive(cube, i))
+            if (!frames.inductive(cube, i, Query::consecution))
             {
                 highest = i - 1; // previous was greatest inductive frame
                 break;
             }
         }
 
-        SPDLOG_LOGGER_TRACE(logger.spd_logger,
-                            "{}| highest inductive frame is {}", logger.tab(),
-                            highest);
+        PDR_TRACE(logger, trace::Event::highest_inductive, highest);
         return highest;
     }
 
-    int PDR::highest_inductive_frame(const z3::expr_vector& cube, int min,
-                                     int max, z3::expr_vector& core)
+    template <typename Policy>
+    int PDR<Policy>::highest_inductive_frame(const z3::expr_vector& cube,
+                                             int min, int max,
+                                             z3::expr_vector& core)
     {
+        PDR_PROFILE(logger, "highest_inductive_frame");
         int result = highest_inductive_frame(cube, min, max);
         if (result >= 0 && result >= min) // if unsat result occurs
         {
@@ -53,44 +65,50 @@ namespace pdr
             core = frames.solver(result)->unsat_core(next_lits, to_current);
 
             // if I => !core, the subclause survives initiation and is inductive
-            if (frames.init_solver.check(core) == z3::sat) 
+            if (frames.init_intersects(core, Query::initiation))
                 core = cube; /// I /=> !core, use original
         }
         else
             core = cube; // no core produced
 
-        SPDLOG_LOGGER_TRACE(logger.spd_logger,
-                            "{}| reduction by unsat core: {} -> {}",
-                            logger.tab(), cube.size(), core.size());
+        PDR_TRACE(logger, trace::Event::core_reduction, cube.size(),
+                  core.size());
         return result;
     }
 
-    z3::expr_vector PDR::generalize(const z3::expr_vector& state, int level)
+    template <typename Policy>
+    z3::expr_vector PDR<Policy>::generalize(const z3::expr_vector& state,
+                                            int level)
     {
-        SPDLOG_LOGGER_TRACE(logger.spd_logger, "{}| generalize", logger.tab());
+        PDR_PROFILE(logger, "generalize");
+        PDR_TRACE(logger, trace::Event::generalize);
         logger.indent++;
         z3::expr_vector smaller_cube = MIC(state, level);
         logger.indent--;
 
-        SPDLOG_LOGGER_TRACE(logger.spd_logger, "{}| reduction by MIC: {} -> {}",
-                            logger.tab(), state.size(), smaller_cube.size());
+        PDR_TRACE(logger, trace::Event::mic_reduction, state.size(),
+                  smaller_cube.size());
         // SPDLOG_LOGGER_TRACE(log, "{}| final reduced cube = [{}]", TAB,
         // join(smaller_cube));
         return smaller_cube;
     }
 
-    z3::expr_vector PDR::MIC(const z3::expr_vector& state, int level)
+    template <typename Policy>
+    z3::expr_vector PDR<Policy>::MIC(const z3::expr_vector& state, int level)
     {
-		//used for sorting
-        std::vector<z3::expr> cube = z3ext::convert(state);
+        PDR_PROFILE(logger, "MIC");
+        logger.stats.mic_calls.add(level);
+        Cube cube;
+        cube.reserve(state.size());
+        for (const z3::expr& e : state)
+            cube.push_back(model.literals.to_lit(e));
+        std::sort(cube.begin(), cube.end(), pebbled_first);
 
-        assert(std::is_sorted(cube.begin(), cube.end(), z3ext::expr_less()));
         unsigned attempts = 0;
         for (unsigned i = 0; i < cube.size() && attempts < mic_retries;)
         {
-            std::vector<z3::expr> new_cube(cube.begin(), cube.begin() + i);
-            new_cube.reserve(cube.size() - 1);
-            new_cube.insert(new_cube.end(), cube.begin() + i + 1, cube.end());
+            Cube new_cube(cube);
+            new_cube.erase(i);
 
             logger.indent++;
             if (down(new_cube, level)) 
@@ -98,8 +116,6 @@ namespace pdr
 				// current literal was dropped, i now points to the next
                 cube = std::move(new_cube);
                 attempts = 0;
-                // SPDLOG_LOGGER_TRACE(log, "{}| reduced cube: [{}]", TAB,
-                // join(cube));
             }
             else
             {
@@ -109,37 +125,67 @@ namespace pdr
 			logger.indent--;
         }
 
-        return z3ext::convert(cube);
+        z3::expr_vector rv = model.literals.to_expr(cube);
+        z3ext::sort(rv);
+        return rv;
     }
 
     // state is sorted
-    bool PDR::down(std::vector<z3::expr>& state, int level)
+    template <typename Policy>
+    bool PDR<Policy>::down(Cube& state, int level)
     {
-        assert(std::is_sorted(state.begin(), state.end(), z3ext::expr_less()));
-        auto is_current_in_state = [this, &state](const z3::expr& e)
-        {
-            return model.literals.literal_is_current(e) &&
-                   std::binary_search(state.begin(), state.end(), e,
-                                      z3ext::expr_less());
-        };
+        PDR_PROFILE(logger, "down");
+        assert(std::is_sorted(state.begin(), state.end(), pebbled_first));
+        logger.stats.down_calls.add(level);
 
         while (true)
         {
-            z3::expr* const raw_state = state.data();
-            if (frames.init_solver.check(state.size(), raw_state) == z3::sat)
+            // a sampled state is reachable within level + 1 steps,
+            // so state cannot be blocked at level + 1
+            if (simulation.intersects(state, level + 1))
+            {
+                logger.stats.sim_rejections.add(level);
                 return false;
+            }
 
-            if (Witness w = frames.counter_to_inductiveness(state, level))
+            if (frames.init_intersects(state, Query::mic))
             {
-                // intersect the current states from the model with state
-                std::vector<z3::expr> cti_intersect =
-                    Solver::filter_witness_vector(*w, is_current_in_state);
+                logger.stats.sat_rejections.add(level);
+                return false;
+            }
 
-                state = move(cti_intersect);
+            if (!frames.inductive(state, level, Query::mic))
+            {
+                // intersect the current state from the model with state
+                LitSpan cti = frames.witness_current(level);
+                Cube cti_intersect;
+                for (Lit l : state)
+                    if (std::binary_search(cti.begin(), cti.end(), l))
+                        cti_intersect.push_back(l);
+
+                state = std::move(cti_intersect);
             }
             else
                 return true;
         }
         return false;
     }
+
+    template int PDR<FatPolicy>::highest_inductive_frame(const z3::expr_vector&,
+                                                   int, int);
+    template int PDR<FatPolicy>::highest_inductive_frame(const z3::expr_vector&,
+                                                   int, int, z3::expr_vector&);
+    template z3::expr_vector PDR<FatPolicy>::generalize(const z3::expr_vector&,
+                                                  int);
+    template z3::expr_vector PDR<FatPolicy>::MIC(const z3::expr_vector&, int);
+    template bool PDR<FatPolicy>::down(Cube&, int);
+
+    template int PDR<DeltaPolicy>::highest_inductive_frame(const z3::expr_vector&,
+                                                   int, int);
+    template int PDR<DeltaPolicy>::highest_inductive_frame(const z3::expr_vector&,
+                                                   int, int, z3::expr_vector&);
+    template z3::expr_vector PDR<DeltaPolicy>::generalize(const z3::expr_vector&,
+                                                  int);
+    template z3::expr_vector PDR<DeltaPolicy>::MIC(const z3::expr_vector&, int);
+    template bool PDR<DeltaPolicy>::down(Cube&, int);
 } // namespace pdr
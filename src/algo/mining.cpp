@@ -0,0 +1,144 @@
+#include "pdr.h"
+#include "string-ext.h"
+#include "z3-ext.h"
+
+#include <algorithm>
+#include <cassert>
+#include <set>
+#include <vector>
+#include <z3++.h>
+
+namespace pdr
+{
+  namespace
+  {
+    // a set of nodes S can never be pebbled all at once if, for every x in S,
+    // pebbling x last requires more than k pebbles: |S u children(x)| > k.
+    // assumes S is sorted
+    bool exclusive(const PDRModel& model, const std::vector<int>& S)
+    {
+      for (int x : S)
+      {
+        int needed = S.size();
+        for (int c : model.get_children(x))
+          if (!std::binary_search(S.begin(), S.end(), c))
+            needed++;
+
+        if (needed <= model.get_max_pebbles())
+          return false;
+      }
+      return true;
+    }
+
+    // the cube in which all nodes in S are pebbled
+    z3::expr_vector pebbled_cube(z3::context& ctx, const PDRModel& model,
+                                 const std::vector<int>& S)
+    {
+      z3::expr_vector cube(ctx);
+      for (int x : S)
+        cube.push_back(model.literals(x));
+      z3ext::sort(cube);
+      return cube;
+    }
+  } // namespace
+
+  // candidate invariants: sets of nodes S that are exclusive in the current
+  // cardinality. only nodes with many children can be part of a small set
+  template <typename Policy>
+  std::vector<std::vector<int>> PDR<Policy>::invariant_candidates() const
+  {
+    const int k = model.get_max_pebbles();
+    const int n = model.literals.size();
+    std::set<std::vector<int>> found;
+    std::vector<std::vector<int>> rv;
+
+    auto subsumed = [&found](const std::vector<int>& S)
+    {
+      for (size_t i = 0; i < S.size(); i++)
+      {
+        std::vector<int> smaller(S);
+        smaller.erase(smaller.begin() + i);
+        if (found.find(smaller) != found.end())
+          return true;
+      }
+      return false;
+    };
+    // bound the work spent on enumerating sets, not only the result
+    size_t budget = 100 * mine_limit;
+    auto full     = [&rv, &budget, this]()
+    { return rv.size() >= mine_limit || budget == 0; };
+    auto consider = [&](std::vector<int> S)
+    {
+      if (budget > 0)
+        budget--;
+      std::sort(S.begin(), S.end());
+      if (!subsumed(S) && exclusive(model, S))
+      {
+        found.insert(S);
+        rv.push_back(std::move(S));
+      }
+    };
+
+    std::vector<int> heavy; // may be part of an exclusive triple
+    for (int i = 0; i < n; i++)
+    {
+      consider({ i });
+      if ((int)model.get_children(i).size() >= k - 2)
+        heavy.push_back(i);
+    }
+
+    // nodes that are never pebbled together with all outputs
+    std::vector<int> outputs;
+    for (int i = 0; i < n; i++)
+      if (model.is_output(i))
+        outputs.push_back(i);
+
+    for (int i = 0; i < n && !outputs.empty() && !full(); i++)
+    {
+      if (model.is_output(i))
+        continue;
+      std::vector<int> S(outputs);
+      S.push_back(i);
+      consider(std::move(S));
+    }
+
+    for (size_t i = 0; i < heavy.size() && !full(); i++)
+      for (size_t j = i + 1; j < heavy.size() && !full(); j++)
+        consider({ heavy[i], heavy[j] });
+
+    for (size_t i = 0; i < heavy.size() && !full(); i++)
+      for (size_t j = i + 1; j < heavy.size() && !full(); j++)
+        for (size_t l = j + 1; l < heavy.size() && !full(); l++)
+          consider({ heavy[i], heavy[j], heavy[l] });
+
+    return rv;
+  }
+
+  // install the candidates that are inductive on their own in F_inf
+  template <typename Policy>
+  unsigned PDR<Policy>::mine_invariants()
+  {
+    PDR_PROFILE(logger, "mine_invariants");
+    PDR_TRACE(logger, trace::Event::mining);
+    unsigned n_mined = 0;
+    for (const std::vector<int>& S : invariant_candidates())
+    {
+      z3::expr_vector cube = pebbled_cube(ctx, model, S);
+
+      if (frames.init_intersects(cube, Query::mining))
+        continue;
+      if (frames.inf_inductive(cube, Query::mining) && frames.block_inf(cube))
+        n_mined++;
+    }
+
+    logger.stats.mined_invariants.add(0, n_mined);
+    return n_mined;
+  }
+
+  template std::vector<std::vector<int>>
+  PDR<FatPolicy>::invariant_candidates() const;
+  template std::vector<std::vector<int>>
+  PDR<DeltaPolicy>::invariant_candidates() const;
+  template unsigned PDR<FatPolicy>::mine_invariants();
+  template unsigned PDR<DeltaPolicy>::mine_invariants();
+} // namespace pdr
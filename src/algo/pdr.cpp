@@ -23,45 +23,57 @@
 
 namespace pdr
 {
-  PDR::PDR(PDRModel& m, bool d, Logger& l, PDResults& r)
-      : ctx(m.ctx), model(m), delta(d), logger(l),
-        frames(delta, ctx, m, logger), results(r)
+  template <typename Policy>
+  PDR<Policy>::PDR(PDRModel& m, Logger& l, PDResults& r)
+      : ctx(m.ctx), model(m), logger(l), frames(ctx, m, logger),
+        reachable(ctx, m), results(r), simulation(m, sim_words, sim_steps)
   {
   }
 
-  void PDR::reset()
+  template <typename Policy>
+  void PDR<Policy>::reset()
   {
     logger.indent = 0;
     // trace is already converted into string, discard states
     assert(results.current().trace_string != "");
     results.current().trace.reset();
-    frames_string     = "None";
-    solvers_string    = "None";
+    frames_snapshot.reset();
     shortest_strategy = UINT_MAX;
   }
 
-  void PDR::print_model(const z3::model& m)
+  template <typename Policy>
+  void PDR<Policy>::print_model(const z3::model& m)
   {
-    logger.out() << "model consts \{" << std::endl;
+    PDR_OUT(logger, "model consts {{");
     for (unsigned i = 0; i < m.num_consts(); i++)
-      logger.out() << "\t" << m.get_const_interp(m.get_const_decl(i));
-    logger.out() << "}" << std::endl;
+      PDR_OUT(logger, "\t{}",
+              m.get_const_interp(m.get_const_decl(i)).to_string());
+    PDR_OUT(logger, "}}");
   }
 
-  bool PDR::run(bool optimize)
+  template <typename Policy>
+  bool PDR<Policy>::run(bool optimize)
   {
+    PDR_PROFILE(logger, "run");
     dynamic_cardinality = optimize;
     timer.reset();
 
     assert(k == frames.frontier());
     log_start();
 
+    if (mine)
+      log_and_show(
+          fmt::format("Mined {} structural invariants", mine_invariants()));
+    simulation.run(); // the cardinality may have changed
+
     bool failed = false;
     if (!optimize || k == 0)
     {
       log_and_show("Start initiation");
       logger.indent++;
       failed = !init();
+      if (!failed && fast_forward)
+        fast_forward_frames();
       logger.indent--;
     }
 
@@ -87,28 +99,44 @@ namespace pdr
     return finish(true);
   }
 
-  bool PDR::finish(bool rv)
+  template <typename Policy>
+  bool PDR<Policy>::finish(bool rv)
   {
     double final_time = timer.elapsed().count();
     log_and_show(fmt::format("Total elapsed time {}", final_time));
     results.current().total_time = final_time;
+    results.current().inf_lemmas = frames.get_inf().size();
     logger.stats.elapsed         = final_time;
+    frames.solver_statistics(logger.stats);
     store_result();
-    store_frame_strings();
+    if (snapshot_frames)
+    {
+      TimelineSpan span(logger.timeline, "snapshot_frames");
+      frames_snapshot = frames.snapshot();
+    }
     shortest_strategy = results.current().pebbles_used;
 
+    if (std::shared_ptr<State> trace = results.current().trace)
+    {
+      unsigned n_new = reachable.add_trace(trace);
+      log_and_show(fmt::format("Cached {} new reachable states, {} in total",
+                               n_new, reachable.size()));
+    }
+
     return rv;
   }
 
   // returns true if the model survives initiation
-  bool PDR::init()
+  template <typename Policy>
+  bool PDR<Policy>::init()
   {
+    PDR_PROFILE(logger, "init");
     assert(frames.frontier() == 0);
 
     z3::expr_vector notP = model.n_property.currents();
-    if (frames.init_solver.check(notP))
+    if (frames.init_intersects(notP, Query::initiation))
     {
-      logger.out() << "I =/> P" << std::endl;
+      PDR_OUT(logger, "I =/> P");
       z3::model counter = frames.solver(0)->get_model();
       print_model(counter);
       // TODO TRACE
@@ -117,13 +145,12 @@ namespace pdr
     }
 
     z3::expr_vector notP_next = model.n_property.nexts();
-    if (frames.SAT(0, notP_next))
+    if (frames.SAT(0, notP_next, Query::initiation))
     { // there is a transitions from I to !P
-      logger.out() << "I & T =/> P'" << std::endl;
-      z3::model witness = frames.solver(0)->get_model();
+      PDR_OUT(logger, "I & T =/> P'");
       z3::expr_vector bad_cube =
-          Solver::filter_witness(witness, [this](const z3::expr& e)
-                                 { return model.literals.atom_is_current(e); });
+          model.literals.to_expr(frames.witness_current(0));
+      z3ext::sort(bad_cube);
       results.current().trace = std::make_shared<State>(bad_cube);
 
       return false;
@@ -136,29 +163,77 @@ namespace pdr
     return true;
   }
 
-  bool PDR::iterate()
+  // a node v of depth d cannot be pebbled in fewer than d steps, so !v holds
+  // in F_1..F_d-1. !P requires every output to be pebbled and cannot be
+  // reached before the deepest output. block these unit cubes and start
+  // iterating at the first level that may have a cti
+  template <typename Policy>
+  void PDR<Policy>::fast_forward_frames()
+  {
+    PDR_PROFILE(logger, "fast_forward");
+    assert(k == 1 && k == frames.frontier());
+
+    int target = 1;
+    for (int i = 0; i < model.literals.size(); i++)
+      if (model.is_output(i))
+        target = std::max(target, model.get_depth(i) - 1);
+
+    while ((int)frames.frontier() < target)
+      frames.extend();
+
+    unsigned n_blocked = 0;
+    for (int i = 0; i < model.literals.size(); i++)
+    {
+      int depth = model.get_depth(i);
+      if (depth <= 1)
+        continue;
+
+      z3::expr_vector cube(ctx);
+      cube.push_back(model.literals(i));
+      if (frames.remove_state(cube, std::min(depth - 1, target)))
+        n_blocked++;
+    }
+
+    k = target;
+    assert(k == frames.frontier());
+    log_and_show(fmt::format("Fast-forward to k = {}, blocked {} depth lemmas",
+                             k, n_blocked));
+  }
+
+  template <typename Policy>
+  bool PDR<Policy>::iterate()
   {
-    logger.out() << SEP3 << std::endl << "Start iteration" << std::endl;
+    PDR_PROFILE(logger, "iterate");
+    PDR_OUT(logger, "{}\nStart iteration", SEP3);
 
     // I => P and I & T ⇒ P' (from init)
     while (true) // iterate over k, if dynamic this continues from last k
     {
+      TimelineSpan round(logger.timeline, "iterate", { { "k", k } });
       log_iteration();
       assert(k == frames.frontier());
       // exhaust all counters to the inductiveness of !P
-      while (Witness cti =
-                 frames.get_trans_from_to(k, model.n_property.nexts(), true))
+      while (true)
       {
-
-        if (cti)
+        if (frames.trans_from_to(k, model.n_property.nexts(), Query::cti,
+                                 true))
         {
           // a F_i state leads to violation
-          z3::expr_vector cti_current = Solver::filter_witness(
-              *cti, [this](const z3::expr& e)
-              { return model.literals.atom_is_current(e); });
+          z3::expr_vector cti_current =
+              model.literals.to_expr(frames.witness_current(k));
+          z3ext::sort(cti_current);
 
           log_cti(cti_current);
 
+          // a known reachable state in the cti completes a counterexample
+          int r = reachable.find(cti_current, k);
+          if (r >= 0)
+          {
+            logger.stats.reachable_hits.add(k);
+            results.current().trace = reachable.trace(r, nullptr);
+            return false;
+          }
+
           z3::expr_vector core(ctx);
           int n =
               highest_inductive_frame(cti_current, (int)k - 1, (int)k, core);
@@ -171,12 +246,11 @@ namespace pdr
           if (not block(cti_current, n + 1, k))
             return false;
 
-          logger.out() << std::endl;
+          PDR_OUT(logger, "");
         }
         else // no more counter examples
         {
-          SPDLOG_LOGGER_TRACE(logger.spd_logger, "{}| no more counters at F_{}",
-                              logger.tab(), k);
+          PDR_TRACE(logger, trace::Event::no_cti, k);
           break;
         }
       }
@@ -189,7 +263,8 @@ namespace pdr
       log_propagation(k, time);
 
       k++;
-      frames.log_solvers();
+      frames.trace_lemmas();
+      publish_progress(0);
 
       if (invariant_level >= 0)
       {
@@ -199,15 +274,19 @@ namespace pdr
     }
   }
 
-  bool PDR::block(z3::expr_vector& cti, unsigned n, unsigned level)
+  template <typename Policy>
+  bool PDR<Policy>::block(z3::expr_vector& cti, unsigned n, unsigned level)
   {
-    SPDLOG_LOGGER_TRACE(logger.spd_logger, "{}| block", logger.tab());
+    PDR_PROFILE(logger, "block");
+    TimelineSpan span(logger.timeline, "block",
+                      { { "n", n }, { "level", level } });
+    PDR_TRACE(logger, trace::Event::block);
     logger.indent++;
 
-    unsigned period = 0;
     std::set<Obligation, std::less<Obligation>> obligations;
-    if ((n + 1) <= level)
-      obligations.emplace(n + 1, std::move(cti), 0);
+    // cti is blocked in F_n, an obligation (i, s) pushes s from F_i to F_i+1
+    if (n <= level)
+      obligations.emplace(n, std::move(cti), 0);
 
     // forall (n, state) in obligations: !state->cube is inductive
     // relative to F[i-1]
@@ -215,18 +294,30 @@ namespace pdr
     {
       sub_timer.reset();
       double elapsed;
-      std::string branch;
+      trace::Event branch;
 
       auto [n, state, depth] = *(obligations.begin());
+      TimelineSpan obligation(logger.timeline, "obligation",
+                              { { "level", n }, { "depth", depth } });
       assert(n <= level);
       log_top_obligation(obligations.size(), n, state->cube);
 
-      if (Witness w = frames.counter_to_inductiveness(state->cube, n))
+      // state is not in F_n, a member that is reachable in n + 1 steps
+      // completes a counterexample
+      int r = reachable.find(state->cube, n + 1);
+      if (r >= 0)
+      {
+        logger.stats.reachable_hits.add(n);
+        results.current().trace = reachable.trace(r, state->prev);
+        return false;
+      }
+
+      if (!frames.inductive(state->cube, n, Query::consecution))
       {
         // get predecessor from the witness
-        auto extract_current = [this](const z3::expr& e)
-        { return model.literals.atom_is_current(e); };
-        z3::expr_vector pred_cube = Solver::filter_witness(*w, extract_current);
+        z3::expr_vector pred_cube =
+            model.literals.to_expr(frames.witness_current(n));
+        z3ext::sort(pred_cube);
 
         std::shared_ptr<State> pred = std::make_shared<State>(pred_cube, state);
         log_pred(pred->cube);
@@ -252,7 +343,8 @@ namespace pdr
           return false;
         }
         elapsed = sub_timer.elapsed().count();
-        branch  = "(pred)  ";
+        branch  = trace::Event::obligation_pred;
+        obligation.set({ "branch", 0, "pred" });
       }
       else
       {
@@ -284,57 +376,43 @@ namespace pdr
           return false;
         }
         elapsed = sub_timer.elapsed().count();
-        branch  = "(finish)";
+        branch  = trace::Event::obligation_finish;
+        obligation.set({ "branch", 0, "finish" });
       }
       log_obligation(branch, level, elapsed);
       elapsed = -1.0;
 
-      // periodically write stats in case of long runs
-      /*
-      if (period >= 100)
-      {
-        period = 0;
-        logger.out() << "Stats written" << std::endl;
-        SPDLOG_LOGGER_DEBUG(logger.spd_logger, logger.stats.to_string());
-        logger.spd_logger->flush();
-      }
-      else
-        period++;
-      */
+      publish_progress(obligations.size());
     }
 
     logger.indent--;
     return true;
   }
 
-  void PDR::store_frame_strings()
+  template <typename Policy>
+  void PDR<Policy>::show_solver(std::ostream& out, unsigned it,
+                                const FramesSnapshot* snapshot)
   {
-    std::stringstream ss;
-
-    ss << "Frames" << std::endl;
-    ss << frames.blocked_str() << std::endl;
-
-    frames_string = ss.str();
-
-    ss = std::stringstream();
-
-    ss << "Solvers" << std::endl;
-    ss << frames.solvers_str() << std::endl;
-
-    solvers_string = ss.str();
+    out << SEP3 << " iteration " << it << std::endl;
+    if (snapshot)
+      snapshot->show(out);
+    else
+      out << "None" << std::endl << std::endl << SEP2 << std::endl
+          << "None" << std::endl
+          << std::endl;
   }
 
-  void PDR::show_solver(std::ostream& out, unsigned it) const
+  template <typename Policy>
+  void PDR<Policy>::dump_frames(std::ostream& out) const
   {
-    out << SEP3 << " iteration " << it << std::endl;
-    out << frames_string << std::endl;
-    out << SEP2 << std::endl;
-    out << solvers_string << std::endl;
+    frames.dump(out);
   }
 
-  void PDR::show_results(std::ostream& out) const { results.show(out); }
+  template <typename Policy>
+  void PDR<Policy>::show_results(std::ostream& out) const { results.show(out); }
 
-  void PDR::store_result()
+  template <typename Policy>
+  void PDR<Policy>::store_result()
   {
     if (std::shared_ptr<State> current = results.current().trace)
     {
@@ -380,8 +458,9 @@ namespace pdr
     }
   }
 
-  void PDR::show_trace(const std::shared_ptr<State> trace_root,
-                       std::ostream& out) const
+  template <typename Policy>
+  void PDR<Policy>::show_trace(const std::shared_ptr<State> trace_root,
+                               std::ostream& out) const
   {
     std::vector<std::tuple<unsigned, std::string, unsigned>> steps;
 
@@ -420,105 +499,116 @@ namespace pdr
         << std::endl;
   }
 
-  Statistics& PDR::stats() { return logger.stats; }
-  int PDR::length_shortest_strategy() const { return shortest_strategy; }
+  template <typename Policy>
+  Statistics& PDR<Policy>::stats() { return logger.stats; }
+  template <typename Policy>
+  int PDR<Policy>::length_shortest_strategy() const
+  {
+    return shortest_strategy;
+  }
 
   // LOGGING AND STAT COLLECTION SHORTHANDS
   //
-  void PDR::log_and_show(const std::string& str) const
+  template <typename Policy>
+  void PDR<Policy>::log_and_show(const std::string& str) const
   {
-    logger.out() << str << std::endl;
+    PDR_OUT(logger, "{}", str);
     SPDLOG_LOGGER_INFO(logger.spd_logger, str);
   }
 
-  void PDR::log_start() const
+  template <typename Policy>
+  void PDR<Policy>::log_start() const
   {
     SPDLOG_LOGGER_INFO(logger.spd_logger, "");
     SPDLOG_LOGGER_INFO(logger.spd_logger, "NEW RUN\n");
-    logger.out() << std::endl;
+    PDR_OUT(logger, "");
     log_and_show("PDR start:");
   }
 
-  void PDR::log_iteration()
+  template <typename Policy>
+  void PDR<Policy>::log_iteration()
   {
-    logger.out() << "###############" << std::endl;
-    logger.out() << "iterate frame " << k << std::endl;
-    SPDLOG_LOGGER_TRACE(logger.spd_logger, "");
-    SPDLOG_LOGGER_TRACE(logger.spd_logger, SEP3);
-    SPDLOG_LOGGER_TRACE(logger.spd_logger, "{}| frame {}", logger.tab(), k);
+    PDR_OUT(logger, "###############\niterate frame {}", k);
+    PDR_TRACE(logger, trace::Event::iteration, k);
   }
 
-  void PDR::log_cti(const z3::expr_vector& cti)
+  template <typename Policy>
+  void PDR<Policy>::log_cti(const z3::expr_vector& cti)
   {
     (void)cti; // ignore unused warning when logging is off
-    SPDLOG_LOGGER_TRACE(logger.spd_logger, SEP2);
-    SPDLOG_LOGGER_TRACE(logger.spd_logger, "{}| cti at frame {}", logger.tab(),
-                        k);
-    SPDLOG_LOGGER_TRACE(logger.spd_logger, "{}| [{}]", logger.tab(),
-                        str::extend::join(cti));
+    PDR_TRACE(logger, trace::Event::cti, k, 0, cti);
   }
 
-  void PDR::log_propagation(unsigned level, double time)
+  template <typename Policy>
+  void PDR<Policy>::log_propagation(unsigned level, double time)
   {
-    std::string msg = fmt::format("Propagation elapsed {}", time);
-    SPDLOG_LOGGER_TRACE(logger.spd_logger, msg);
-    logger.out() << msg << std::endl;
+    PDR_TRACE(logger, trace::Event::propagation, time);
+    PDR_OUT(logger, "Propagation elapsed {}", time);
     logger.stats.propagation_it.add_timed(level, time);
   }
 
-  void PDR::log_top_obligation(size_t queue_size, unsigned top_level,
-                               const z3::expr_vector& top)
+  template <typename Policy>
+  void PDR<Policy>::log_top_obligation(size_t queue_size, unsigned top_level,
+                                       const z3::expr_vector& top)
   {
     (void)queue_size; // ignore unused warning when logging is off
     (void)top_level;  // ignore unused warning when logging is off
     (void)top;        // ignore unused warning when logging is off
-    SPDLOG_LOGGER_TRACE(logger.spd_logger, SEP);
-    SPDLOG_LOGGER_TRACE(logger.spd_logger, "{}| obligations pending: {}",
-                        logger.tab(), queue_size);
-    SPDLOG_LOGGER_TRACE(logger.spd_logger, "{}| top obligation", logger.tab());
-    logger.indent++;
-    SPDLOG_LOGGER_TRACE(logger.spd_logger, "{}| {}, [{}]", logger.tab(),
-                        top_level, str::extend::join(top));
-    logger.indent--;
+    PDR_TRACE(logger, trace::Event::top_obligation, queue_size, top_level,
+              top);
   }
 
-  void PDR::log_pred(const z3::expr_vector& p)
+  template <typename Policy>
+  void PDR<Policy>::log_pred(const z3::expr_vector& p)
   {
     (void)p; // ignore unused warning when logging is off
-    SPDLOG_LOGGER_TRACE(logger.spd_logger, "{}| predecessor:", logger.tab());
-    logger.indent++;
-    SPDLOG_LOGGER_TRACE(logger.spd_logger, "{}| [{}]", logger.tab(),
-                        str::extend::join(p));
-    logger.indent--;
+    PDR_TRACE(logger, trace::Event::pred, 0, 0, p);
   }
 
-  void PDR::log_state_push(unsigned frame, const z3::expr_vector& p)
+  template <typename Policy>
+  void PDR<Policy>::log_state_push(unsigned frame, const z3::expr_vector& p)
   {
     (void)frame; // ignore unused warning when logging is off
     (void)p;     // ignore unused warning when logging is off
-    SPDLOG_LOGGER_TRACE(logger.spd_logger, "{}| pred is inductive until F_{}",
-                        frame - 1, logger.tab());
-    SPDLOG_LOGGER_TRACE(logger.spd_logger,
-                        "{}| push predecessor to level {}: [{}]", logger.tab(),
-                        frame, str::extend::join(p));
+    PDR_TRACE(logger, trace::Event::push, frame - 1, frame, p);
   }
 
-  void PDR::log_finish(const z3::expr_vector& s)
+  template <typename Policy>
+  void PDR<Policy>::log_finish(const z3::expr_vector& s)
   {
     (void)s; // ignore unused warning when logging is off
-    SPDLOG_LOGGER_TRACE(logger.spd_logger, "{}| finishing state", logger.tab());
-    logger.indent++;
-    SPDLOG_LOGGER_TRACE(logger.spd_logger, "{}| [{}]", logger.tab(),
-                        str::extend::join(s));
-    logger.indent--;
+    PDR_TRACE(logger, trace::Event::finish, 0, 0, s);
   }
 
-  void PDR::log_obligation(const std::string& type, unsigned l, double time)
+  template <typename Policy>
+  void PDR<Policy>::log_obligation(trace::Event type, unsigned l,
+                                   double time)
   {
     logger.stats.obligations_handled.add_timed(l, time);
-    std::string msg = fmt::format("Obligation {} elapsed {}", type, time);
-    SPDLOG_LOGGER_TRACE(logger.spd_logger, msg);
-    logger.out() << msg << std::endl;
+    PDR_TRACE(logger, type, time);
+    PDR_OUT(logger, "Obligation {} elapsed {}",
+            type == trace::Event::obligation_pred ? "(pred)  " : "(finish)",
+            time);
+  }
+
+  template <typename Policy>
+  void PDR<Policy>::publish_progress(size_t queue_size)
+  {
+    if (!logger.monitor || !logger.monitor->due())
+      return;
+
+    Snapshot s;
+    s.k = k;
+    for (size_t i = 0; i <= frames.frontier(); i++)
+      s.frame_sizes.push_back(frames[i].get_blocked().size());
+    s.inf_size            = frames.get_inf().size();
+    s.obligations         = queue_size;
+    s.obligations_handled = logger.stats.obligations_handled.total_count;
+    s.solver_calls        = logger.stats.solver_calls.total_count;
+    s.query_latency       = logger.stats.query_latency;
+    logger.monitor->publish(std::move(s));
   }
 
+  template class PDR<FatPolicy>;
+  template class PDR<DeltaPolicy>;
 } // namespace pdr
@@ -0,0 +1,152 @@
+#include "reachable.h"
+#include "z3-ext.h"
+
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <z3++.h>
+
+namespace pdr
+{
+  ReachableStates::ReachableStates(z3::context& c, const PDRModel& m)
+      : model(m), words((m.literals.size() + 63) / 64), step_solver(c)
+  {
+    reset_solver();
+  }
+
+  void ReachableStates::reset_solver()
+  {
+    step_solver.reset();
+    step_solver.add(model.get_transition());
+    step_solver.add(model.get_cardinality());
+  }
+
+  int ReachableStates::insert(Bits&& pebbled, z3::expr_vector&& cube,
+                              int parent)
+  {
+    auto it = index.find(pebbled);
+    if (it != index.end())
+      return it->second;
+
+    int pebbles = 0;
+    for (const z3::expr& e : cube)
+      if (!e.is_not())
+        pebbles++;
+
+    unsigned depth = parent < 0 ? 1 : entries.at(parent).depth + 1;
+    index.emplace(pebbled, entries.size());
+    entries.push_back(
+        { std::move(pebbled), std::move(cube), depth, parent, pebbles });
+    return entries.size() - 1;
+  }
+
+  // the cubes in a trace may be partial. find a full state in every cube
+  // that is a successor of the previous full state
+  unsigned ReachableStates::add_trace(const std::shared_ptr<State>& root)
+  {
+    size_t before = entries.size();
+    z3::expr_vector from = model.get_initial();
+    int parent           = -1;
+
+    for (std::shared_ptr<State> s = root; s; s = s->prev)
+    {
+      z3::expr_vector assumptions = z3ext::copy(from);
+      for (const z3::expr& e : model.literals.p(s->cube))
+        assumptions.push_back(e);
+
+      if (step_solver.check(assumptions) != z3::sat)
+        break;
+
+      z3::model witness = step_solver.get_model();
+      Bits pebbled(words, 0);
+      z3::expr_vector full(from.ctx());
+      for (int i = 0; i < model.literals.size(); i++)
+      {
+        if (witness.eval(model.literals.p(i), true).is_true())
+        {
+          pebbled[i / 64] |= uint64_t(1) << (i % 64);
+          full.push_back(model.literals(i));
+        }
+        else
+          full.push_back(!model.literals(i));
+      }
+
+      from   = z3ext::copy(full);
+      parent = insert(std::move(pebbled), std::move(full), parent);
+    }
+
+    return entries.size() - before;
+  }
+
+  int ReachableStates::find(const z3::expr_vector& cube,
+                            unsigned max_depth) const
+  {
+    if (entries.empty())
+      return -1;
+
+    Bits pos(words, 0), neg(words, 0);
+    for (const z3::expr& e : cube)
+    {
+      bool negated = e.is_not();
+      int i = model.literals.indexof(negated ? e.arg(0) : e);
+      (negated ? neg : pos)[i / 64] |= uint64_t(1) << (i % 64);
+    }
+
+    // the state lies in the cube if it pebbles every positive literal and
+    // none of the negative ones
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+      const Entry& entry = entries[i];
+      if (entry.depth > max_depth)
+        continue;
+
+      bool in_cube = true;
+      for (size_t w = 0; w < words && in_cube; w++)
+        in_cube = (pos[w] & ~entry.pebbled[w]) == 0 &&
+                  (neg[w] & entry.pebbled[w]) == 0;
+      if (in_cube)
+        return i;
+    }
+    return -1;
+  }
+
+  std::shared_ptr<State> ReachableStates::trace(int i,
+                                                std::shared_ptr<State> next) const
+  {
+    std::shared_ptr<State> current = next;
+    for (; i >= 0; i = entries.at(i).parent)
+      current = std::make_shared<State>(entries.at(i).cube, current);
+    return current;
+  }
+
+  // entries are stored after their parent. a single pass removes every state
+  // that is either too large or has a removed parent
+  void ReachableStates::restrict()
+  {
+    const int k = model.get_max_pebbles();
+    std::vector<int> new_index(entries.size(), -1);
+    std::vector<Entry> kept;
+
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+      Entry& e = entries[i];
+      if (e.pebbles > k || (e.parent >= 0 && new_index[e.parent] < 0))
+        continue;
+
+      if (e.parent >= 0)
+        e.parent = new_index[e.parent];
+      new_index[i] = kept.size();
+      kept.push_back(std::move(e));
+    }
+
+    entries = std::move(kept);
+    index.clear();
+    for (size_t i = 0; i < entries.size(); i++)
+      index.emplace(entries[i].pebbled, i);
+
+    reset_solver();
+  }
+
+  size_t ReachableStates::size() const { return entries.size(); }
+} // namespace pdr
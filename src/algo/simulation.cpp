@@ -0,0 +1,126 @@
+#include "simulation.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include <z3++.h>
+
+namespace pdr
+{
+  Simulation::Simulation(const PDRModel& m, unsigned n_words, unsigned n_steps)
+      : model(m), words(n_words), steps(n_steps), rng(2022)
+  {
+  }
+
+  void Simulation::run()
+  {
+    snapshots.clear();
+    snapshots.reserve(steps);
+    Words current(model.literals.size() * words, 0); // I
+    for (unsigned i = 0; i < steps; i++)
+    {
+      current = step(current);
+      snapshots.push_back(current);
+    }
+  }
+
+  Simulation::Words Simulation::step(const Words& current)
+  {
+    const int n = model.literals.size();
+
+    // a node may flip if all its children are pebbled, try with p = 1/4
+    Words flip(n * words);
+    for (int v = 0; v < n; v++)
+      for (unsigned w = 0; w < words; w++)
+      {
+        uint64_t enabled = ~uint64_t(0);
+        for (int c : model.get_children(v))
+          enabled &= current[c * words + w];
+        flip[v * words + w] = enabled & rng() & rng();
+      }
+
+    // children must also be pebbled in the next state: a flipping child
+    // cancels the flip of its parent
+    Words next(current);
+    for (int v = 0; v < n; v++)
+      for (unsigned w = 0; w < words; w++)
+      {
+        uint64_t child_flips = 0;
+        for (int c : model.get_children(v))
+          child_flips |= flip[c * words + w];
+        next[v * words + w] ^= flip[v * words + w] & ~child_flips;
+      }
+
+    // walks that would exceed the cardinality stay in place
+    Words over = exceeds(next, model.get_max_pebbles());
+    for (int v = 0; v < n; v++)
+      for (unsigned w = 0; w < words; w++)
+      {
+        uint64_t& x = next[v * words + w];
+        x           = (x & ~over[w]) | (current[v * words + w] & over[w]);
+      }
+
+    return next;
+  }
+
+  // counts the pebbles of all walks at once in a bit-sliced counter
+  Simulation::Words Simulation::exceeds(const Words& state, int k) const
+  {
+    const int n = model.literals.size();
+    Words rv(words, 0);
+    if (k >= n)
+      return rv;
+
+    unsigned bits = 1;
+    while ((1 << bits) <= n)
+      bits++;
+
+    std::vector<Words> count(bits, Words(words, 0));
+    for (int v = 0; v < n; v++)
+      for (unsigned w = 0; w < words; w++)
+      {
+        uint64_t carry = state[v * words + w];
+        for (unsigned j = 0; j < bits && carry; j++)
+        {
+          uint64_t overflow = count[j][w] & carry;
+          count[j][w] ^= carry;
+          carry = overflow;
+        }
+      }
+
+    // compare from the most significant bit: count > k
+    for (unsigned w = 0; w < words; w++)
+    {
+      uint64_t greater = 0, equal = ~uint64_t(0);
+      for (int j = bits - 1; j >= 0; j--)
+      {
+        uint64_t k_bit = (k >> j) & 1 ? ~uint64_t(0) : 0;
+        greater |= equal & count[j][w] & ~k_bit;
+        equal &= ~(count[j][w] ^ k_bit);
+      }
+      rv[w] = greater;
+    }
+    return rv;
+  }
+
+  bool Simulation::intersects(LitSpan cube, unsigned max_steps) const
+  {
+    size_t last = std::min<size_t>(max_steps, snapshots.size());
+    for (size_t i = 0; i < last; i++)
+      for (unsigned w = 0; w < words; w++)
+      {
+        uint64_t in_cube = ~uint64_t(0);
+        for (Lit l : cube)
+        {
+          uint64_t pebbled = snapshots[i][lit_var(l) * words + w];
+          in_cube &= lit_sign(l) ? ~pebbled : pebbled;
+          if (!in_cube)
+            break;
+        }
+        if (in_cube)
+          return true;
+      }
+    return false;
+  }
+} // namespace pdr
@@ -1,22 +1,40 @@
 #include "solver.h"
 #include "frame.h"
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <vector>
 #include <z3++.h>
 
 namespace pdr
 {
-    Solver::Solver(z3::context& c, std::vector<z3::expr_vector> base)
-        : ctx(c), internal_solver(ctx), base_assertions(std::move(base))
+    Solver::Solver(z3::context& c, std::vector<z3::expr_vector> base,
+                   queries::QueryLog* l)
+        : ctx(c), internal_solver(ctx), log(l),
+          base_assertions(std::move(base))
     {
+        if (log)
+            log_id = log->new_solver();
         init();
     }
 
+    void Solver::set(const char* key, bool value)
+    {
+        internal_solver.set(key, value);
+        if (log)
+            log->param(log_id, key, value ? "true" : "false");
+    }
+
     void Solver::init()
     {
-        internal_solver.set("sat.cardinality.solver", true);
-        internal_solver.set("cardinality.solver", true);
+        set("sat.cardinality.solver", true);
+        set("cardinality.solver", true);
         // consecution_solver.set("lookahead_simplify", true);
         for (const z3::expr_vector& v : base_assertions)
-            internal_solver.add(v);
+            for (const z3::expr& e : v)
+                add(e);
 
         cubes_start = std::accumulate(
             base_assertions.begin(), base_assertions.end(), 0,
@@ -25,7 +43,11 @@ namespace pdr
 
     void Solver::reset()
     {
+        // z3 clears its statistics on reset
+        retired = statistics();
         internal_solver.reset();
+        if (log)
+            log->reset(log_id);
         init();
     }
 
@@ -50,10 +72,23 @@ namespace pdr
         this->add(clause | !act);
     }
 
-    void Solver::add(const z3::expr& e) { internal_solver.add(e); }
+    void Solver::add(const z3::expr& e)
+    {
+        internal_solver.add(e);
+        if (log)
+            log->add(log_id, e);
+    }
 
     bool Solver::SAT(const z3::expr_vector& assumptions)
     {
+        if (log)
+        {
+            std::vector<Z3_ast> asts;
+            for (const z3::expr& e : assumptions)
+                asts.push_back(e);
+            return SAT(asts.data(), asts.size());
+        }
+
         z3::check_result result = internal_solver.check(assumptions);
         if (result == z3::sat)
             return true;
@@ -64,8 +99,57 @@ namespace pdr
         return false;
     }
 
+    bool Solver::SAT(const Z3_ast* assumptions, unsigned n)
+    {
+        auto start      = std::chrono::steady_clock::now();
+        Z3_lbool result = Z3_solver_check_assumptions(ctx, internal_solver, n,
+                                                      assumptions);
+        ctx.check_error();
+        if (log)
+        {
+            std::chrono::duration<double> dt(std::chrono::steady_clock::now() -
+                                             start);
+            log->check(log_id, ctx, assumptions, n, result, dt.count());
+        }
+        if (result == Z3_L_TRUE)
+            return true;
+
+        assert(result != Z3_L_UNDEF);
+
+        core_available = true;
+        return false;
+    }
+
     z3::model Solver::get_model() const { return internal_solver.get_model(); }
 
+    LitSpan Solver::witness(const std::vector<z3::expr>& vars)
+    {
+        Z3_model raw = Z3_solver_get_model(ctx, internal_solver);
+        ctx.check_error();
+        // holds a reference, also released when a value is not constant
+        z3::model m(ctx, raw);
+
+        witness_buffer.clear();
+        witness_buffer.reserve(vars.size());
+        for (unsigned i = 0; i < vars.size(); i++)
+        {
+            Z3_func_decl var = Z3_get_app_decl(ctx, Z3_to_app(ctx, vars[i]));
+            Z3_ast value     = Z3_model_get_const_interp(ctx, m, var);
+            if (!value)
+                continue;
+
+            Z3_lbool b = Z3_get_bool_value(ctx, value);
+            if (b == Z3_L_TRUE)
+                witness_buffer.push_back(mk_lit(i));
+            else if (b == Z3_L_FALSE)
+                witness_buffer.push_back(mk_lit(i, true));
+            else
+                throw std::runtime_error("model contains non-constant");
+        }
+
+        return witness_buffer;
+    }
+
     z3::expr_vector Solver::unsat_core()
     {
         assert(core_available);
@@ -74,18 +158,73 @@ namespace pdr
         return core;
     }
 
+    SolverStats Solver::statistics() const
+    {
+        SolverStats rv = retired;
+        rv.assertions  = internal_solver.assertions().size();
+
+        z3::stats stats = internal_solver.statistics();
+        // the smt core counts every propagation in "propagations", its
+        // "binary propagations" are a subset. the sat core splits them by
+        // clause size. use the split counts if the sat core ran, else the
+        // smt total, so none are counted twice
+        uint64_t smt_propagations = 0, sat_propagations = 0;
+        for (unsigned i = 0; i < stats.size(); i++)
+        {
+            // key() returns a copy, keep it alive for the view
+            std::string name = stats.key(i);
+            std::string_view key(name);
+            // the sat core prefixes its keys
+            bool sat_core = key.substr(0, 4) == "sat ";
+            if (sat_core)
+                key.remove_prefix(4);
+
+            if (key == "max memory")
+            {
+                rv.max_memory = std::max(rv.max_memory, stats.double_value(i));
+                continue;
+            }
+            if (!stats.is_uint(i))
+                continue;
+
+            uint64_t value = stats.uint_value(i);
+            if (key == "conflicts")
+                rv.conflicts += value;
+            else if (key == "decisions")
+                rv.decisions += value;
+            else if (sat_core && (key == "propagations 2ary" ||
+                                  key == "propagations 3ary" ||
+                                  key == "propagations nary"))
+                sat_propagations += value;
+            else if (!sat_core && key == "propagations")
+                smt_propagations += value;
+            else if (key == "restarts")
+                rv.restarts += value;
+            else if (key == "pb conflicts")
+                rv.pb_conflicts += value;
+            else if (key == "pb propagations")
+                rv.pb_propagations += value;
+        }
+        rv.propagations +=
+            sat_propagations > 0 ? sat_propagations : smt_propagations;
+        return rv;
+    }
+
     std::string Solver::as_str(const std::string& header) const
     {
         std::string str(header);
-        const z3::expr_vector asserts = internal_solver.assertions();
-
-        auto it = asserts.begin();
-        for (unsigned i = 0; i < cubes_start && it != asserts.end(); i++)
-            it++;
-
-        for (; it != asserts.end(); it++)
-            str += fmt::format("- {}\n", (*it).to_string());
+        for (const z3::expr& e : lemmas())
+            str += fmt::format("- {}\n", e.to_string());
 
         return str;
     }
+
+    z3::expr_vector Solver::lemmas() const
+    {
+        const z3::expr_vector asserts = internal_solver.assertions();
+        z3::expr_vector rv(ctx);
+        for (unsigned i = cubes_start; i < asserts.size(); i++)
+            rv.push_back(asserts[i]);
+        return rv;
+    }
 } // namespace pdr
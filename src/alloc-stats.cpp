@@ -0,0 +1,81 @@
+#include "profiler.h"
+
+// replaces the global operator new and delete with malloc and free, and
+// counts every allocation in the current phase of the Profiler. only
+// compiled in with the ALLOC_STATS option
+#ifdef PDR_ALLOC_STATS
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+  inline void count(std::size_t n)
+  {
+    if (pdr::AllocCount* phase = pdr::alloc_phase)
+    {
+      phase->count++;
+      phase->bytes += n;
+    }
+  }
+
+  void* allocate(std::size_t n)
+  {
+    count(n);
+    if (void* p = std::malloc(n > 0 ? n : 1))
+      return p;
+    throw std::bad_alloc();
+  }
+
+  void* allocate(std::size_t n, std::align_val_t al)
+  {
+    count(n);
+    std::size_t a = static_cast<std::size_t>(al);
+    // aligned_alloc needs a multiple of the alignment
+    if (void* p = std::aligned_alloc(a, (n + a - 1) / a * a + (n == 0) * a))
+      return p;
+    throw std::bad_alloc();
+  }
+} // namespace
+
+void* operator new(std::size_t n) { return allocate(n); }
+void* operator new[](std::size_t n) { return allocate(n); }
+void* operator new(std::size_t n, std::align_val_t a)
+{
+  return allocate(n, a);
+}
+void* operator new[](std::size_t n, std::align_val_t a)
+{
+  return allocate(n, a);
+}
+
+void* operator new(std::size_t n, const std::nothrow_t&) noexcept
+{
+  count(n);
+  return std::malloc(n > 0 ? n : 1);
+}
+void* operator new[](std::size_t n, const std::nothrow_t&) noexcept
+{
+  count(n);
+  return std::malloc(n > 0 ? n : 1);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept
+{
+  std::free(p);
+}
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept
+{
+  std::free(p);
+}
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+  std::free(p);
+}
+#endif // PDR_ALLOC_STATS
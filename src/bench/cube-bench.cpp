@@ -0,0 +1,296 @@
+#include "dag.h"
+#include "exp-cache.h"
+#include "frame.h"
+#include "lit.h"
+#include "logger.h"
+#include "solver.h"
+#include "z3-ext.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fmt/core.h>
+#include <fstream>
+#include <functional>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <z3++.h>
+
+// microbenchmarks of the cube and frame kernels of blocking and propagation:
+// subsumption, cube ordering, Frame::remove_subsumed, diff and equals, the
+// witness of a Solver, ExpressionCache::p and Solver::block.
+// runs on synthetic frames of random cubes, or on the frames of a real run
+// written by pebbling-pdr --dump-frames.
+// usage: cube-bench [n_literals] [cube size] [cubes per frame]
+//        cube-bench --frames <dump file>
+namespace
+{
+  using namespace pdr;
+  using std::chrono::steady_clock;
+  using Cubes = std::vector<z3::expr_vector>;
+
+  // runs f until it took at least 0.2s, doubling the iterations, and reports
+  // the time per iteration. f returns a checksum so its work is not optimized
+  // away
+  void measure(const std::string& name, const std::function<size_t()>& f)
+  {
+    size_t checksum = 0;
+    for (uint64_t iterations = 1;; iterations *= 2)
+    {
+      auto start = steady_clock::now();
+      for (uint64_t i = 0; i < iterations; i++)
+        checksum += f();
+      std::chrono::duration<double, std::nano> diff(steady_clock::now() -
+                                                    start);
+      if (diff.count() >= 2e8 || iterations >= (1ull << 30))
+      {
+        fmt::print("{:<40} {:>12.1f} ns {:>12}  (checksum {})\n", name,
+                   diff.count() / iterations, iterations, checksum);
+        return;
+      }
+    }
+  }
+
+  z3::expr_vector to_cube(const ExpressionCache& lits,
+                          const std::vector<Lit>& cube)
+  {
+    z3::expr_vector rv = lits.to_expr(cube);
+    z3ext::sort(rv);
+    return rv;
+  }
+
+  // frames of a dump of Frames::dump. a run starts at every header
+  std::vector<Cubes> read_dump(const std::string& filename,
+                               ExpressionCache& lits)
+  {
+    std::ifstream in(filename);
+    if (!in.is_open())
+      throw std::runtime_error("Failed to open " + filename);
+
+    std::vector<std::vector<std::vector<Lit>>> frames;
+    unsigned n_vars = 0;
+    for (std::string line; std::getline(in, line);)
+    {
+      std::istringstream words(line);
+      std::string first;
+      words >> first;
+      if (first == "#")
+      {
+        std::string pdr, frames_word;
+        unsigned n;
+        if (words >> pdr >> frames_word >> n)
+          n_vars = std::max(n_vars, n);
+      }
+      else if (first == "frame" || first == "inf")
+        frames.emplace_back();
+      else if (!first.empty() && !frames.empty())
+      {
+        std::vector<Lit> cube = { static_cast<Lit>(std::stoul(first)) };
+        for (Lit l; words >> l;)
+          cube.push_back(l);
+        frames.back().push_back(cube);
+      }
+    }
+
+    for (unsigned i = 0; i < n_vars; i++)
+      lits.add_literal(fmt::format("n{}", i));
+    lits.finish();
+
+    std::vector<Cubes> rv;
+    for (const auto& frame : frames)
+    {
+      rv.emplace_back();
+      for (const std::vector<Lit>& cube : frame)
+        rv.back().push_back(to_cube(lits, cube));
+    }
+    return rv;
+  }
+
+  // n frames of random cubes over the literals of lits. every frame keeps
+  // 90% of the cubes of the previous one, as propagation leaves them
+  std::vector<Cubes> synthetic(ExpressionCache& lits, int n_lits,
+                               int cube_size, int n_cubes, int n)
+  {
+    for (int i = 0; i < n_lits; i++)
+      lits.add_literal(fmt::format("n{}", i));
+    lits.finish();
+
+    std::mt19937 rng(2022);
+    std::uniform_int_distribution<unsigned> var(0, n_lits - 1);
+    std::bernoulli_distribution negated(0.5), keep(0.9);
+    auto random_cube = [&]()
+    {
+      std::vector<Lit> cube;
+      std::vector<bool> used(n_lits, false);
+      while ((int)cube.size() < cube_size)
+      {
+        unsigned v = var(rng);
+        if (!used[v])
+        {
+          used[v] = true;
+          cube.push_back(mk_lit(v, negated(rng)));
+        }
+      }
+      return to_cube(lits, cube);
+    };
+
+    std::vector<Cubes> frames(n);
+    for (int i = 0; i < n_cubes; i++)
+      frames[0].push_back(random_cube());
+    for (int f = 1; f < n; f++)
+      for (const z3::expr_vector& cube : frames[f - 1])
+        frames[f].push_back(keep(rng) ? cube : random_cube());
+    return frames;
+  }
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  z3::context ctx;
+  ExpressionCache lits(ctx);
+  std::vector<Cubes> frames;
+  if (argc > 2 && std::string(argv[1]) == "--frames")
+  {
+    frames = read_dump(argv[2], lits);
+    fmt::print("{}: {} literals, {} frames\n", argv[2], lits.size(),
+               frames.size());
+  }
+  else
+  {
+    const int n_lits    = argc > 1 ? std::atoi(argv[1]) : 500;
+    const int cube_size = std::min(n_lits, argc > 2 ? std::atoi(argv[2]) : 16);
+    const int n_cubes   = argc > 3 ? std::atoi(argv[3]) : 1000;
+    frames = synthetic(lits, n_lits, cube_size, n_cubes, 2);
+    fmt::print("{} literals, {} cubes of {} per frame (density {:.3f})\n",
+               n_lits, n_cubes, cube_size, (double)cube_size / n_lits);
+  }
+
+  // the largest frame and its successor, for the pairwise kernels
+  size_t largest = 0;
+  for (size_t i = 0; i < frames.size(); i++)
+    if (frames[i].size() > frames[largest].size())
+      largest = i;
+  const Cubes& cubes = frames.at(largest);
+  const Cubes& next =
+      largest + 1 < frames.size() ? frames[largest + 1] : frames[largest];
+  if (cubes.empty())
+  {
+    fmt::print("no cubes\n");
+    return 1;
+  }
+  fmt::print("using frame {} with {} cubes\n\n", largest, cubes.size());
+  fmt::print("{:<40} {:>15} {:>12}\n", "Benchmark", "Time", "Iterations");
+
+  dag::Graph G;
+  Logger logger("/dev/null", G, OutLvl::silent);
+  Frame frame(1, logger), frame_next(2, logger);
+  Cubes probes; // cubes of next that frame does not block
+  for (const z3::expr_vector& c : cubes)
+    if (!frame.get_blocked().count(c))
+      frame.block(c);
+  for (const z3::expr_vector& c : next)
+  {
+    if (!frame_next.get_blocked().count(c))
+      frame_next.block(c);
+    if (!frame.get_blocked().count(c) && probes.size() < 16)
+      probes.push_back(c);
+  }
+
+  measure(fmt::format("subsumes/{}", cubes.size()),
+          [&]()
+          {
+            size_t sum = 0;
+            for (size_t i = 0; i + 1 < cubes.size(); i++)
+              sum += z3ext::subsumes(cubes[i], cubes[i + 1]);
+            return sum;
+          });
+
+  measure(fmt::format("expr_vector_less/sort/{}", cubes.size()),
+          [&]()
+          {
+            Cubes sorted(cubes);
+            std::sort(sorted.begin(), sorted.end(),
+                      z3ext::expr_vector_less());
+            return sorted.size();
+          });
+
+  measure(fmt::format("CubeSet/insert/{}", cubes.size()),
+          [&]()
+          {
+            CubeSet set(cubes.begin(), cubes.end());
+            return set.size();
+          });
+
+  // a probe rarely subsumes a blocked cube, and only removes it the first
+  // time: this measures the scan. on a copy, the other kernels use frame
+  {
+    Frame pruned(3, logger);
+    for (const z3::expr_vector& c : frame.get_blocked())
+      pruned.block(c);
+    measure(fmt::format("Frame::remove_subsumed/{}x{}", probes.size(),
+                        cubes.size()),
+            [&]()
+            {
+              size_t sum = 0;
+              for (const z3::expr_vector& c : probes)
+                sum += pruned.remove_subsumed(c);
+              return sum;
+            });
+  }
+
+  measure(fmt::format("Frame::diff/{}", cubes.size()),
+          [&]() { return frame.diff(frame_next).size(); });
+
+  measure(fmt::format("Frame::equals/{}", cubes.size()),
+          [&]() { return (size_t)frame.equals(frame); });
+
+  measure(fmt::format("ExpressionCache::p/{}", cubes.size()),
+          [&]()
+          {
+            size_t sum = 0;
+            for (const z3::expr_vector& c : cubes)
+              sum += lits.p(c).size();
+            return sum;
+          });
+
+  measure(fmt::format("clause/{}", cubes.size()),
+          [&]()
+          {
+            size_t sum = 0;
+            for (const z3::expr_vector& c : cubes)
+              sum += z3::mk_or(z3ext::negate(c)).id();
+            return sum;
+          });
+
+  {
+    Solver solver(ctx, {});
+    measure(fmt::format("Solver::block/{}", cubes.size()),
+            [&]()
+            {
+              solver.reset();
+              for (const z3::expr_vector& c : cubes)
+                solver.block(c);
+              return cubes.size();
+            });
+  }
+
+  {
+    // a model of the blocked cubes of the frame, over all literals
+    Solver solver(ctx, {});
+    for (const z3::expr_vector& c : cubes)
+      solver.block(c);
+    if (!solver.SAT(z3::expr_vector(ctx)))
+      fmt::print("frame is unsatisfiable, skipping Solver::witness\n");
+    else
+    {
+      const std::vector<z3::expr>& vars = lits.vars();
+      measure(fmt::format("Solver::witness/{}", vars.size()),
+              [&]() { return solver.witness(vars).size(); });
+    }
+  }
+
+  return 0;
+}
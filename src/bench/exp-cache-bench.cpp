@@ -0,0 +1,128 @@
+#include "exp-cache.h"
+#include "lit.h"
+#include "z3-ext.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <fmt/core.h>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+#include <z3++.h>
+
+// microbenchmark of the ExpressionCache lookups that run on every literal of
+// every cube: literal <-> index, current <-> next and the literal filters.
+// usage: exp-cache-bench [n_literals] [repetitions]
+namespace
+{
+  using std::chrono::steady_clock;
+
+  // runs f reps times and reports the time per literal
+  void measure(const std::string& name, unsigned reps, size_t lits_per_rep,
+               const std::function<size_t()>& f)
+  {
+    size_t checksum = 0;
+    auto start      = steady_clock::now();
+    for (unsigned i = 0; i < reps; i++)
+      checksum += f();
+    std::chrono::duration<double, std::nano> diff(steady_clock::now() -
+                                                  start);
+
+    double per_lit = diff.count() / ((double)reps * lits_per_rep);
+    fmt::print("{:<28} {:>8.1f} ns/lit  (checksum {})\n", name, per_lit,
+               checksum);
+  }
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  const int n_lits    = argc > 1 ? std::atoi(argv[1]) : 1000;
+  const unsigned reps = argc > 2 ? std::atoi(argv[2]) : 2000;
+  const int cube_size = std::min(n_lits, 64);
+
+  z3::context ctx;
+  ExpressionCache cache(ctx);
+  for (int i = 0; i < n_lits; i++)
+    cache.add_literal(fmt::format("n{}", i));
+  cache.finish();
+
+  // random cubes of current and next state literals, as found in MIC and in
+  // unsat cores
+  std::mt19937 rng(2022);
+  std::uniform_int_distribution<int> node(0, n_lits - 1);
+  std::bernoulli_distribution negated(0.5);
+  std::vector<z3::expr_vector> cubes, cubes_p;
+  for (int i = 0; i < 64; i++)
+  {
+    z3::expr_vector cube(ctx), cube_p(ctx);
+    for (int j = 0; j < cube_size; j++)
+    {
+      int v  = node(rng);
+      bool n = negated(rng);
+      cube.push_back(n ? !cache(v) : cache(v));
+      cube_p.push_back(n ? !cache.p(v) : cache.p(v));
+    }
+    cubes.push_back(cube);
+    cubes_p.push_back(cube_p);
+  }
+  const size_t per_rep = cubes.size() * cube_size;
+
+  fmt::print("{} literals, cubes of {}, {} repetitions\n", n_lits, cube_size,
+             reps);
+
+  measure("to_lit", reps, per_rep,
+          [&]()
+          {
+            size_t sum = 0;
+            for (const z3::expr_vector& c : cubes)
+              for (const z3::expr& e : c)
+                sum += cache.to_lit(e);
+            return sum;
+          });
+
+  measure("literal_is_current", reps, per_rep,
+          [&]()
+          {
+            size_t sum = 0;
+            for (const z3::expr_vector& c : cubes)
+              for (const z3::expr& e : c)
+                sum += cache.literal_is_current(e);
+            return sum;
+          });
+
+  measure("literal_is_p + operator()", reps, per_rep,
+          [&]()
+          {
+            size_t sum = 0;
+            for (const z3::expr_vector& c : cubes_p)
+              for (const z3::expr& e : c)
+                if (cache.literal_is_p(e))
+                  sum += cache(e).id();
+            return sum;
+          });
+
+  measure("p(cube)", reps, per_rep,
+          [&]()
+          {
+            size_t sum = 0;
+            for (const z3::expr_vector& c : cubes)
+              sum += cache.p(c).size();
+            return sum;
+          });
+
+  measure("indexof", reps, per_rep,
+          [&]()
+          {
+            size_t sum = 0;
+            for (const z3::expr_vector& c : cubes)
+              for (const z3::expr& e : c)
+                sum += cache.indexof(e.is_not() ? e.arg(0) : e);
+            return sum;
+          });
+
+  measure("nexts()", reps, n_lits,
+          [&]() { return (size_t)cache.nexts().size(); });
+
+  return 0;
+}
@@ -1,86 +1,179 @@
 #include "dag.h"
 
+#include <algorithm>
+#include <numeric>
+#include <sstream>
+
 namespace dag
 {
   Graph::Graph() {}
   Graph::Graph(const std::string& s) : name(s) {}
-  Graph::Graph(const std::string& name, const std::string& dotstring)
-      : image(std::make_unique<graphviz::Graph>(dotstring)), name(name)
+  Node Graph::vertex(const std::string& name)
   {
-    image->foreach_node(
-        [this](Agnode_t* node)
-        {
-          auto [name, type] = image->name_of(node);
-          switch (type)
-          {
-            case graphviz::XMGnode::pi: add_input(name); break;
-            case graphviz::XMGnode::po: break;
-            case graphviz::XMGnode::node: add_node(name);
-          }
-
-          std::vector<std::string> c = image->children_of(node);
-
-          if (type == graphviz::XMGnode::po)
-          {
-            assert(c.size() == 1);
-            add_output(c[0]);
-          }
-          else
-            add_edges_to(c, name);
-        });
+    assert(!finished);
+    auto [it, inserted] = ids.emplace(name, names.size());
+    if (inserted)
+    {
+      names.push_back(name);
+      flags.push_back(0);
+    }
+    return it->second;
   }
 
-  void Graph::add_input(std::string iname) { input.insert(node(iname)); }
+  void Graph::add_input(std::string iname)
+  {
+    flags[vertex(node(iname))] |= input_flag;
+  }
 
-  void Graph::add_node(std::string nname) { nodes.insert(node(nname)); }
+  void Graph::add_node(std::string nname)
+  {
+    flags[vertex(node(nname))] |= node_flag;
+  }
 
   void Graph::add_output(std::string oname)
   {
-    nodes.insert(node(oname));
-    output.insert(node(oname));
+    flags[vertex(node(oname))] |= node_flag | output_flag;
   }
 
   void Graph::add_edges_to(std::vector<std::string> from, std::string to)
   {
-    if (from.empty())
-      return;
-
-    to = node(to);
-    assert(nodes.find(to) != nodes.end());
-
-    std::vector<std::string> to_children;
-    to_children.reserve(from.size());
+    Node t = vertex(node(to));
+    for (const std::string& f : from)
+      added.emplace_back(t, vertex(node(f)));
+  }
 
-    for (std::string i : from)
+  void Graph::finish()
+  {
+    assert(!finished);
+    finished = true;
+
+    // nodes first, then the remaining inputs, each in order of name
+    std::vector<Node> order(names.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(),
+              [this](Node a, Node b)
+              {
+                bool a_node = flags[a] & node_flag, b_node = flags[b] & node_flag;
+                if (a_node != b_node)
+                  return a_node;
+                return names[a] < names[b];
+              });
+    std::vector<Node> renamed(names.size());
+    for (size_t i = 0; i < order.size(); i++)
+      renamed[order[i]] = i;
+
+    std::vector<std::string> old_names = std::move(names);
+    std::vector<uint8_t> old_flags     = std::move(flags);
+    names.resize(old_names.size());
+    flags.resize(old_flags.size());
+    for (size_t i = 0; i < order.size(); i++)
     {
-      std::string n = node(i);
-      if (input.find(n) != input.end())
+      names[i] = std::move(old_names[order[i]]);
+      flags[i] = old_flags[order[i]];
+    }
+    for (auto& [name, id] : ids)
+      id = renamed[id];
+
+    n_nodes = std::count_if(flags.begin(), flags.end(),
+                            [](uint8_t f) { return f & node_flag; });
+    n_inputs = std::count_if(flags.begin(), flags.end(),
+                             [](uint8_t f) { return f & input_flag; });
+    for (size_t v = 0; v < n_nodes; v++)
+      if (flags[v] & output_flag)
+        outputs.push_back(v);
+
+    // children in the order they were added, without repeats. an edge from
+    // an input does not constrain pebbling
+    std::vector<std::pair<Node, Node>> edges;
+    edges.reserve(added.size());
+    for (auto [to, from] : added)
+    {
+      to   = renamed[to];
+      from = renamed[from];
+      assert(flags[to] & node_flag);
+      if (flags[from] & input_flag)
+        input_edges.emplace_back(from, to);
+      else
+        edges.emplace_back(to, from);
+    }
+    added = {};
+    std::stable_sort(edges.begin(), edges.end(),
+                     [](const auto& a, const auto& b)
+                     { return a.first < b.first; });
+    std::sort(input_edges.begin(), input_edges.end());
+    input_edges.erase(std::unique(input_edges.begin(), input_edges.end()),
+                      input_edges.end());
+
+    child_offsets.assign(n_nodes + 1, 0);
+    std::vector<Node> last_parent(n_nodes, -1);
+    for (auto [to, from] : edges)
+      if (last_parent[from] != to)
       {
-        input_edges.emplace(n, to);
-        continue;
+        last_parent[from] = to;
+        child_ids.push_back(from);
+        child_offsets[to + 1]++;
       }
+    std::partial_sum(child_offsets.begin(), child_offsets.end(),
+                     child_offsets.begin());
+
+    // parents by counting sort on the children
+    parent_offsets.assign(n_nodes + 1, 0);
+    for (Node c : child_ids)
+      parent_offsets[c + 1]++;
+    std::partial_sum(parent_offsets.begin(), parent_offsets.end(),
+                     parent_offsets.begin());
+    parent_ids.resize(child_ids.size());
+    std::vector<uint32_t> next(parent_offsets.begin(),
+                               parent_offsets.end() - 1);
+    for (size_t v = 0; v < n_nodes; v++)
+      for (Node c : get_children(v))
+        parent_ids[next[c]++] = v;
+  }
 
-      assert(nodes.find(n) != nodes.end());
-      edges.emplace(n, to);
-      to_children.push_back(n);
-    }
-
-    children.emplace(to, std::move(to_children));
+  Node Graph::find(const std::string& name) const
+  {
+    auto it = ids.find(name);
+    return it == ids.end() ? -1 : it->second;
   }
 
   std::string Graph::summary() const
   {
-    return fmt::format("Graph {{ In: {}, Out {}, Nodes {} }}", input.size(),
-                       output.size(), nodes.size());
+    return fmt::format("Graph {{ In: {}, Out {}, Nodes {} }}", n_inputs,
+                       outputs.size(), n_nodes);
   }
 
   std::ostream& operator<<(std::ostream& stream, Graph const& g)
   {
+    auto join = [&g](auto first, auto last)
+    {
+      std::string rv;
+      for (auto it = first; it != last; it++)
+        rv += (rv.empty() ? "" : ", ") + g.names[*it];
+      return rv;
+    };
+    std::vector<Node> inputs;
+    for (size_t v = 0; v < g.names.size(); v++)
+      if (g.flags[v] & Graph::input_flag)
+        inputs.push_back(v);
+    std::sort(inputs.begin(), inputs.end(), [&g](Node a, Node b)
+              { return g.names[a] < g.names[b]; });
+    std::vector<Node> nodes(g.n_nodes);
+    std::iota(nodes.begin(), nodes.end(), 0);
+
+    std::string edges;
+    for (size_t v = 0; v < g.n_nodes; v++)
+      for (Node c : g.get_children(v))
+        edges += fmt::format("{}({}, {})", edges.empty() ? "" : ", ",
+                             g.names[c], g.names[v]);
+
     stream << "DAG \{" << std::endl
-           << "\tinput { " << str::extend::join(g.input) << " }" << std::endl
-           << "\toutput { " << str::extend::join(g.output) << " }" << std::endl
-           << "\tnodes { " << str::extend::join(g.nodes) << " }" << std::endl
-           << "\tedges { " << str::extend::join(g.edges) << " }" << std::endl
+           << "\tinput { " << join(inputs.begin(), inputs.end()) << " }"
+           << std::endl
+           << "\toutput { " << join(g.outputs.begin(), g.outputs.end())
+           << " }" << std::endl
+           << "\tnodes { " << join(nodes.begin(), nodes.end()) << " }"
+           << std::endl
+           << "\tedges { " << edges << " }" << std::endl
            << "}" << std::endl;
     return stream;
   }
@@ -97,33 +190,19 @@ namespace dag
     std::stringstream ss;
     ss << "digraph G {" << std::endl;
 
-    for (const Edge& e : input_edges)
-      ss << fmt::format("{} -> {};", e.from, e.to) << std::endl;
-    for (const Edge& e : edges)
-      ss << fmt::format("{} -> {};", e.from, e.to) << std::endl;
+    for (auto [from, to] : input_edges)
+      ss << fmt::format("{} -> {};", names[from], names[to]) << std::endl;
+    for (size_t v = 0; v < n_nodes; v++)
+      for (Node c : get_children(v))
+        ss << fmt::format("{} -> {};", names[c], names[v]) << std::endl;
 
-    for (const std::string& o : input)
-      ss << fmt::format("{} [shape=plain];", o) << std::endl;
-    for (const std::string& o : output)
-      ss << fmt::format("{} [shape=doublecircle];", o) << std::endl;
+    for (size_t v = 0; v < names.size(); v++)
+      if (flags[v] & input_flag)
+        ss << fmt::format("{} [shape=plain];", names[v]) << std::endl;
+    for (Node o : outputs)
+      ss << fmt::format("{} [shape=doublecircle];", names[o]) << std::endl;
 
     ss << "}" << std::endl;
     return ss.str();
   }
-
-  bool Graph::is_output(const std::string& name) const
-  {
-    return output.find(name) != output.end();
-  }
-
-  const std::vector<std::string>&
-      Graph::get_children(const std::string& key) const
-  {
-    auto result = children.find(key);
-
-    if (result == children.end())
-      return empty_vec;
-
-    return result->second;
-  }
 } // namespace dag
@@ -1,4 +1,6 @@
 #include "pdr-model.h"
+
+#include <string>
 #include <z3++.h>
 
 PDRModel::PDRModel(const std::string& model_name, const dag::Graph& G,
@@ -8,8 +10,9 @@ PDRModel::PDRModel(const std::string& model_name, const dag::Graph& G,
 {
   name = model_name;
 
-  for (std::string node : G.nodes)
-    literals.add_literal(node);
+  // literal i is node i of G
+  for (size_t v = 0; v < G.size(); v++)
+    literals.add_literal(G.name_of(v));
   literals.finish();
 
   for (const z3::expr& e : literals.currents())
@@ -18,9 +21,12 @@ PDRModel::PDRModel(const std::string& model_name, const dag::Graph& G,
   // load_pebble_transition_raw2(G);
   load_pebble_transition(G);
 
-  final_pebbles = G.output.size();
+  final_pebbles = G.output_size();
+  lower_bound   = dag::pebbling_lower_bound(G);
   set_max_pebbles(pebbles);
 
+  depths = dag::node_depths(G);
+
   load_property(G);
 }
 
@@ -37,15 +43,14 @@ const z3::expr_vector& PDRModel::get_cardinality() const { return cardinality; }
 
 void PDRModel::load_pebble_transition(const dag::Graph& G)
 {
+  children.assign(literals.size(), {});
   for (int i = 0; i < literals.size(); i++) // every node has a transition
   {
-    std::string name = literals(i).to_string();
     // pebble if all children are pebbled now and next
     // or unpebble if all children are pebbled now and next
-    for (const std::string& child : G.get_children(name))
+    for (int child_i : G.get_children(i))
     {
-      z3::expr child_node = ctx.bool_const(child.c_str());
-      int child_i         = literals.indexof(child_node);
+      children[i].push_back(child_i);
 
       transition.push_back(literals(i) || !literals.p(i) || literals(child_i));
       transition.push_back(!literals(i) || literals.p(i) || literals(child_i));
@@ -61,14 +66,11 @@ void PDRModel::load_pebble_transition_raw1(const dag::Graph& G)
 {
   for (int i = 0; i < literals.size(); i++) // every node has a transition
   {
-    std::string name     = literals(i).to_string();
     z3::expr parent_flip = literals(i) ^ literals.p(i);
     // pebble if all children are pebbled now and next
     // or unpebble if all children are pebbled now and next
-    for (const std::string& child : G.get_children(name))
+    for (int child_i : G.get_children(i))
     {
-      z3::expr child_node    = ctx.bool_const(child.c_str());
-      int child_i            = literals.indexof(child_node);
       z3::expr child_pebbled = literals(child_i) & literals.p(child_i);
 
       transition.push_back(z3::implies(parent_flip, child_pebbled));
@@ -80,15 +82,12 @@ void PDRModel::load_pebble_transition_raw2(const dag::Graph& G)
 {
   for (int i = 0; i < literals.size(); i++) // every node has a transition
   {
-    std::string name     = literals(i).to_string();
     z3::expr parent_flip = literals(i) ^ literals.p(i);
     // pebble if all children are pebbled now and next
     // or unpebble if all children are pebbled now and next
     z3::expr_vector children_pebbled(ctx);
-    for (const std::string& child : G.get_children(name))
+    for (int child_i : G.get_children(i))
     {
-      z3::expr child_node = ctx.bool_const(child.c_str());
-      int child_i         = literals.indexof(child_node);
       children_pebbled.push_back(literals(child_i));
       children_pebbled.push_back(literals.p(child_i));
     }
@@ -99,24 +98,28 @@ void PDRModel::load_pebble_transition_raw2(const dag::Graph& G)
 
 void PDRModel::load_property(const dag::Graph& G)
 {
+  outputs.assign(literals.size(), false);
+  for (int i = 0; i < literals.size(); i++)
+    outputs[i] = G.is_output(i);
+
   // final nodes are pebbled and others are not
-  for (const z3::expr& e : literals.currents())
+  for (int i = 0; i < literals.size(); i++)
   {
-    if (G.is_output(e.to_string()))
-      n_property.add_expression(e, literals);
+    if (outputs[i])
+      n_property.add_expression(literals(i), literals.p(i));
     else
-      n_property.add_expression(!e, literals);
+      n_property.add_expression(!literals(i), !literals.p(i));
   }
   n_property.finish();
 
   // final nodes are unpebbled and others are
   z3::expr_vector disjunction(ctx);
-  for (const z3::expr& e : literals.currents())
+  for (int i = 0; i < literals.size(); i++)
   {
-    if (G.is_output(e.to_string()))
-      disjunction.push_back(!e);
+    if (outputs[i])
+      disjunction.push_back(!literals(i));
     else
-      disjunction.push_back(e);
+      disjunction.push_back(literals(i));
   }
   property.add_expression(z3::mk_or(disjunction), literals);
   property.finish();
@@ -131,17 +134,41 @@ bool PDRModel::set_max_pebbles(int x)
   cardinality = z3::expr_vector(ctx);
   cardinality.push_back(z3::atmost(literals.currents(), max_pebbles));
   cardinality.push_back(z3::atmost(literals.nexts(), max_pebbles));
-  return x >= final_pebbles;
+  return x >= lower_bound.pebbles;
 }
 
 int PDRModel::get_f_pebbles() const { return final_pebbles; }
+const dag::LowerBound& PDRModel::get_lower_bound() const { return lower_bound; }
+
+const std::vector<int>& PDRModel::get_children(int node) const
+{
+  return children.at(node);
+}
+
+bool PDRModel::is_output(int node) const { return outputs.at(node); }
+int PDRModel::get_depth(int node) const { return depths.at(node); }
 
-void PDRModel::show(std::ostream& out) const
+void PDRModel::show(std::ostream& out) const { show(out, shown()); }
+
+std::vector<z3::expr_vector> PDRModel::shown() const
 {
-  literals.show(out);
-  out << "Transition Relation:" << std::endl << transition << std::endl;
+  return { literals.currents(),   literals.nexts(),   transition,
+           property.currents(),   property.nexts(),   n_property.currents(),
+           n_property.nexts() };
+}
+
+void PDRModel::show(std::ostream& out, const std::vector<z3::expr_vector>& e)
+{
+  // as ExpressionCache::show
+  auto show_cache = [&out](const z3::expr_vector& c, const z3::expr_vector& n)
+  {
+    out << "Lits:      " << str::extend::join(c) << std::endl;
+    out << "Next Lits: " << str::extend::join(n) << std::endl;
+  };
+  show_cache(e.at(0), e.at(1));
+  out << "Transition Relation:" << std::endl << e.at(2) << std::endl;
   out << "property: " << std::endl;
-  property.show(out);
+  show_cache(e.at(3), e.at(4));
   out << "not_property: " << std::endl;
-  n_property.show(out);
+  show_cache(e.at(5), e.at(6));
 }
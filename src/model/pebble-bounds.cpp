@@ -0,0 +1,199 @@
+#include "pebble-bounds.h"
+
+#include <algorithm>
+#include <fmt/format.h>
+#include <string>
+#include <vector>
+
+namespace dag
+{
+  namespace
+  {
+    // post-order evaluation of f over the children of every node, without
+    // recursion so deep graphs do not overflow the stack
+    // f: (node, child values) -> value
+    template <typename Fn> std::vector<int> bottom_up(const Graph& G, Fn&& f)
+    {
+      std::vector<int> memo(G.size());
+      std::vector<bool> done(G.size(), false);
+      std::vector<Node> todo;
+      std::vector<int> values;
+      for (size_t root = 0; root < G.size(); root++)
+      {
+        todo.push_back(root);
+        while (!todo.empty())
+        {
+          Node n = todo.back();
+          if (done[n])
+          {
+            todo.pop_back();
+            continue;
+          }
+
+          bool ready = true;
+          for (Node c : G.get_children(n))
+            if (!done[c])
+            {
+              todo.push_back(c);
+              ready = false;
+            }
+          if (!ready)
+            continue;
+
+          todo.pop_back();
+          values.clear();
+          for (Node c : G.get_children(n))
+            values.push_back(memo[c]);
+          memo[n] = f(n, values);
+          done[n] = true;
+        }
+      }
+      return memo;
+    }
+
+    // the nodes some output depends on. other nodes never need a pebble, so
+    // they do not count towards a bound
+    std::vector<bool> output_cones(const Graph& G)
+    {
+      std::vector<bool> rv(G.size(), false);
+      std::vector<Node> todo(G.get_outputs());
+      for (Node o : todo)
+        rv[o] = true;
+      while (!todo.empty())
+      {
+        Node n = todo.back();
+        todo.pop_back();
+        for (Node c : G.get_children(n))
+          if (!rv[c])
+          {
+            rv[c] = true;
+            todo.push_back(c);
+          }
+      }
+      return rv;
+    }
+  } // namespace
+
+  std::string LowerBound::str() const
+  {
+    return fmt::format("{} ({})", pebbles, reason);
+  }
+
+  LowerBound output_bound(const Graph& G)
+  {
+    return { (int)G.output_size(), "number of outputs" };
+  }
+
+  LowerBound fanin_bound(const Graph& G)
+  {
+    std::vector<bool> relevant = output_cones(G);
+    LowerBound rv{ 0, "max fan-in + 1" };
+    for (size_t n = 0; n < G.size(); n++)
+      if (relevant[n])
+        rv.pebbles = std::max(rv.pebbles, (int)G.get_children(n).size() + 1);
+    return rv;
+  }
+
+  LowerBound output_cut_bound(const Graph& G)
+  {
+    if (G.get_outputs().empty())
+      return { 0, "outputs and children of the last pebbled output" };
+
+    int fewest = G.size();
+    for (Node o : G.get_outputs())
+    {
+      Nodes children = G.get_children(o);
+      int others = std::count_if(children.begin(), children.end(),
+                                 [&G](Node c) { return !G.is_output(c); });
+      fewest     = std::min(fewest, others);
+    }
+
+    return { (int)G.output_size() + fewest,
+             "outputs and children of the last pebbled output" };
+  }
+
+  LowerBound tree_bound(const Graph& G)
+  {
+    std::vector<bool> relevant = output_cones(G);
+    // -1 if the cone of a node is not a tree. parents outside the output
+    // cones are never pebbled and do not break a tree
+    auto price = [&G, &relevant](Node n, std::vector<int> children)
+    {
+      for (Node c : G.get_children(n))
+      {
+        Nodes parents = G.get_parents(c);
+        if (std::count_if(parents.begin(), parents.end(),
+                          [&relevant](Node p) { return relevant[p]; }) != 1)
+          return -1;
+      }
+      if (std::find(children.begin(), children.end(), -1) != children.end())
+        return -1;
+
+      // pebble the subtrees in descending order of their cost, keeping the
+      // roots of the finished subtrees pebbled
+      std::sort(children.begin(), children.end(), std::greater<int>());
+      int rv = children.size() + 1;
+      for (size_t i = 0; i < children.size(); i++)
+        rv = std::max(rv, children[i] + (int)i);
+      return rv;
+    };
+
+    LowerBound rv{ 0, "pebbling number of the largest fanout-free cone" };
+    std::vector<int> costs = bottom_up(G, price);
+    for (size_t n = 0; n < G.size(); n++)
+      if (relevant[n])
+        rv.pebbles = std::max(rv.pebbles, costs[n]);
+    return rv;
+  }
+
+  LowerBound chain_bound(const Graph& G)
+  {
+    // longest path ending in a node, not passing through an output
+    auto longest = [&G](Node n, const std::vector<int>& children)
+    {
+      int rv         = 1;
+      Nodes c_nodes = G.get_children(n);
+      for (size_t i = 0; i < c_nodes.size(); i++)
+        if (!G.is_output(c_nodes[i]))
+          rv = std::max(rv, children[i] + 1);
+      return rv;
+    };
+    std::vector<int> length = bottom_up(G, longest);
+
+    int n = 0;
+    for (Node o : G.get_outputs())
+      n = std::max(n, length.at(o));
+    if (n == 0)
+      return { 0, "longest path to an output" };
+
+    int log2n = 0;
+    while ((1 << log2n) < n)
+      log2n++;
+
+    return { 1 + log2n,
+             fmt::format("reversible pebbling of a path of length {}", n) };
+  }
+
+  LowerBound pebbling_lower_bound(const Graph& G)
+  {
+    std::vector<LowerBound> bounds = { output_bound(G), fanin_bound(G),
+                                       output_cut_bound(G), tree_bound(G),
+                                       chain_bound(G) };
+
+    return *std::max_element(bounds.begin(), bounds.end(),
+                             [](const LowerBound& a, const LowerBound& b)
+                             { return a.pebbles < b.pebbles; });
+  }
+
+  std::vector<int> node_depths(const Graph& G)
+  {
+    auto depth = [](Node, const std::vector<int>& children)
+    {
+      int deepest = 0;
+      for (int d : children)
+        deepest = std::max(deepest, d);
+      return deepest + 1;
+    };
+    return bottom_up(G, depth);
+  }
+} // namespace dag
@@ -1,4 +1,5 @@
-﻿#include "dag.h"
+﻿#include "artifacts.h"
+#include "dag.h"
 #include "h-operator.h"
 #include "logger.h"
 #include "mockturtle/networks/klut.hpp"
@@ -10,6 +11,7 @@
 #include <algorithm>
 #include <array>
 #include <cassert>
+#include <chrono>
 #include <cstring>
 #include <cxxopts.hpp>
 #include <exception>
@@ -61,7 +63,28 @@ struct ArgumentList
   bool opt;
   bool delta;
   bool onlyshow;
+  bool dag_image;
+  // the graph, model and solver dump files
+  pdr::Artifacts artifacts;
   bool one;
+  bool mine;
+  bool fast_forward;
+
+  // Chrome trace_event output, none if empty
+  std::string trace_events;
+  // snapshot to .progress.jsonl every progress_period seconds and every
+  // progress_every obligations, if 0 only periodically. only if progress
+  bool progress;
+  double progress_period;
+  unsigned progress_every;
+  // totals of the run as json, for pebbling-bench. none if empty
+  std::string bench_summary;
+  // write the cubes of the frames after every run, for cube-bench
+  bool dump_frames;
+  // binary log of the solver operations, for query-replay. none if empty
+  std::string record_queries;
+  // read hardware counters in every profiled phase
+  bool perf_counters;
 
   bool _failed = false;
 };
@@ -111,7 +134,8 @@ cxxopts::Options make_options(std::string name, ArgumentList& clargs)
 {
   cxxopts::Options clopt(name, "Find a pebbling strategy using a minumum "
                                "amount of pebbles through PDR");
-  clargs.opt = clargs.delta = false;
+  clargs.opt = clargs.delta = clargs.dump_frames = clargs.dag_image =
+      false;
   // clang-format off
   clopt.add_options()
     ("v,verbose", "Output all during pdr iterations",
@@ -120,6 +144,10 @@ cxxopts::Options make_options(std::string name, ArgumentList& clargs)
       cxxopts::value<bool>()->default_value("false"))
     ("showonly", "Only write the given model to its output file, does not run the algorithm.",
      cxxopts::value<bool>(clargs.onlyshow))
+    ("dag-image", "Render the DAG with graphviz to dag.svg in the model folder. Implied by --showonly.",
+     cxxopts::value<bool>(clargs.dag_image))
+    ("artifacts", "Write the graph, model and solver dump in full, only their sizes (summary), or not at all (none). Written on a separate thread.",
+     cxxopts::value<std::string>()->default_value("full"), "none|summary|full")
 
     ("o,optimize", "Multiple runs that find a strategy with minimum pebbles.",
       cxxopts::value<bool>(clargs.opt))
@@ -127,6 +155,24 @@ cxxopts::Options make_options(std::string name, ArgumentList& clargs)
       cxxopts::value<bool>(clargs.delta))
     ("one", "Only run one iteration of pdr, which verifies if there is a strategy for the number of pebbles.",
       cxxopts::value<bool>(clargs.one))
+    ("mine", "Mine structural invariants from the DAG before each run.",
+      cxxopts::value<bool>(clargs.mine))
+    ("fast-forward", "Block nodes in the frames below their depth in the DAG, and start iterating at the depth of the outputs.",
+      cxxopts::value<bool>(clargs.fast_forward))
+    ("trace-events", "Write a timeline of the run in Chrome trace_event JSON to FILE, for Perfetto or chrome://tracing.",
+      cxxopts::value<std::string>(clargs.trace_events), "string:FILE")
+    ("progress-period", "Append a snapshot of the run to the .progress.jsonl file every SEC seconds. Off unless this or progress-every is given.",
+      cxxopts::value<double>(clargs.progress_period)->default_value("10"), "float:SEC")
+    ("progress-every", "Also append a snapshot after every N handled obligations. 0 only appends periodically.",
+      cxxopts::value<unsigned>(clargs.progress_every)->default_value("0"), "uint:N")
+    ("record-queries", "Write every solver operation to FILE in a binary log, replayed by query-replay.",
+      cxxopts::value<std::string>(clargs.record_queries), "string:FILE")
+    ("dump-frames", "Write the cubes of the frames after each run to the .frames file, read by cube-bench.",
+      cxxopts::value<bool>(clargs.dump_frames))
+    ("perf-counters", "Count cycles, instructions, cache and branch misses per profiled phase (linux perf_event_open).",
+      cxxopts::value<bool>(clargs.perf_counters))
+    ("bench-summary", "Write the solver calls and obligations of the run as JSON to FILE, read by pebbling-bench.",
+      cxxopts::value<std::string>(clargs.bench_summary), "string:FILE")
 
     ("dir","Directory (relative to ./) than contains runable benchmarks.",
       cxxopts::value<fs::path>()->default_value(BENCH_FOLDER), "string:F")
@@ -210,6 +256,14 @@ ArgumentList parse_cl(int argc, char* argv[])
     else // begin
       clargs.max_pebbles = -1;
 
+    clargs.progress =
+        clresult.count("progress-period") || clresult.count("progress-every");
+    if (clargs.progress_period <= 0)
+      throw std::invalid_argument("progress-period must be greater than 0.");
+
+    clargs.artifacts =
+        pdr::parse_artifacts(clresult["artifacts"].as<std::string>());
+
     clargs.bench_folder = BENCH_FOLDER / clresult["dir"].as<fs::path>();
   }
   catch (const std::exception& e)
@@ -248,9 +302,63 @@ void show_header(const ArgumentList& clargs)
             << (clargs.opt ? "Using dynamic cardinality. " : "")
             << (clargs.delta ? "Using delta-encoded frames." : "") << std::endl;
 }
+
+void show_bound(const PDRModel& model)
+{
+  std::cout << fmt::format("Structural lower bound: {}",
+                           model.get_lower_bound().str())
+            << std::endl;
+}
 //
 // end OUTPUT
 
+// times the setup before the logger exists, added to its profile
+class SetupPhases
+{
+ private:
+  using clock = std::chrono::steady_clock;
+
+  std::unique_ptr<pdr::perf::Counters> counters;
+  clock::time_point start_time;
+  pdr::perf::Counts start_counts;
+  std::vector<std::tuple<const char*, uint64_t, pdr::perf::Counts>> phases;
+
+  pdr::perf::Counts read() const
+  {
+    return counters ? counters->read() : pdr::perf::Counts();
+  }
+
+ public:
+  SetupPhases(bool count_hardware)
+  {
+    if (count_hardware)
+      counters = std::make_unique<pdr::perf::Counters>();
+  }
+
+  void start()
+  {
+    start_time   = clock::now();
+    start_counts = read();
+  }
+
+  void stop(const char* name)
+  {
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        clock::now() - start_time);
+    phases.emplace_back(name, ns.count(), read() - start_counts);
+  }
+
+  // adds the phases to p and closes the counters, so they are not
+  // multiplexed with those of p
+  void record(pdr::Profiler& p)
+  {
+    for (const auto& [name, ns, counts] : phases)
+      p.record(name, ns, counts);
+    phases.clear();
+    counters.reset();
+  }
+};
+
 dag::Graph build_dag(const ArgumentList& args)
 {
   dag::Graph G;
@@ -279,7 +387,7 @@ dag::Graph build_dag(const ArgumentList& args)
         throw std::invalid_argument(model_file.string() +
                                         " is not a valid .bench file");
 
-      G = dag::from_dot(klut, args.model_name); // TODO continue
+      G = dag::from_network(klut, args.model_name); // TODO continue
     }
     break;
 
@@ -299,6 +407,80 @@ std::ostream& operator<<(std::ostream& o, std::exception const& e)
   return o;
 }
 
+// writes the frames and solvers at the last finish of algorithm to out, on
+// the artifact thread. none if out is null
+template <typename Policy>
+void show_solver(pdr::ArtifactWriter& artifacts,
+                 const std::shared_ptr<std::ofstream>& out,
+                 const pdr::PDR<Policy>& algorithm, unsigned it)
+{
+  if (!out)
+    return;
+  artifacts.post(
+      [out, snapshot = algorithm.frames_snapshot, it]()
+      { pdr::PDR<Policy>::show_solver(*out, it, snapshot.get()); });
+}
+
+// runs pdr with the frame encoding Policy and writes the output
+template <typename Policy>
+void run(const ArgumentList& clargs, PDRModel& model, pdr::Logger& pdr_logger,
+         pdr::PDResults& res, std::ostream& stats, std::ostream& strategy,
+         pdr::ArtifactWriter& artifacts,
+         const std::shared_ptr<std::ofstream>& solver_dump,
+         std::ofstream& frames_dump)
+{
+  if (clargs.opt)
+  {
+    pdr::PDR<Policy> algorithm(model, pdr_logger, res);
+    algorithm.mine            = clargs.mine;
+    algorithm.fast_forward    = clargs.fast_forward;
+    algorithm.snapshot_frames = solver_dump != nullptr;
+
+    while (true)
+    {
+      bool found_strategy = !algorithm.run(clargs.opt);
+      stats << "Cardinality: " << model.get_max_pebbles() << std::endl;
+      stats << pdr_logger.stats << std::endl;
+      if (frames_dump.is_open())
+        algorithm.dump_frames(frames_dump);
+
+      if (!found_strategy || clargs.one)
+        break;
+
+      if (algorithm.decrement(true))
+        break;
+    }
+    algorithm.show_results(strategy);
+    show_solver(artifacts, solver_dump, algorithm, clargs.max_pebbles);
+  }
+  else
+  {
+    // TODO multiple normal runs from comparision
+    while (true)
+    {
+      pdr::PDR<Policy> algorithm(model, pdr_logger, res);
+      algorithm.mine            = clargs.mine;
+      algorithm.fast_forward    = clargs.fast_forward;
+      algorithm.snapshot_frames = solver_dump != nullptr;
+      bool found_strategy       = !algorithm.run(clargs.opt);
+      stats << "Cardinality: " << model.get_max_pebbles() << std::endl;
+      stats << pdr_logger.stats << std::endl;
+      if (frames_dump.is_open())
+        algorithm.dump_frames(frames_dump);
+
+      show_solver(artifacts, solver_dump, algorithm, model.get_max_pebbles());
+
+      // stop when no strategy is found, or when the next bound is proven
+      // infeasible. else retry from scratch with fewer pebbles
+      if (clargs.one || !found_strategy || algorithm.decrement())
+      {
+        algorithm.show_results(strategy);
+        break;
+      }
+    }
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 int main(int argc, char* argv[])
@@ -308,79 +490,144 @@ int main(int argc, char* argv[])
   const auto [model_dir, base_dir] = output_paths(clargs);
   std::string filename             = file_name(clargs);
 
-  std::ofstream graph_descr = trunc_file(model_dir, "graph", "txt");
-  std::ofstream model_descr = trunc_file(model_dir, "model", "txt");
-
+  SetupPhases setup(clargs.perf_counters);
+  setup.start();
   dag::Graph G = build_dag(clargs);
+  setup.stop("parse");
+
+  // after G: finishes the jobs that read it before it is destroyed. the other
+  // jobs own their files and snapshots
+  pdr::ArtifactWriter artifacts;
+  auto artifact_file = [&clargs](const fs::path& folder,
+                                 const std::string& filename,
+                                 const std::string& ext)
+  {
+    if (clargs.artifacts == pdr::Artifacts::none)
+      return std::shared_ptr<std::ofstream>();
+    return std::make_shared<std::ofstream>(trunc_file(folder, filename, ext));
+  };
 
-  G.show_image(model_dir / "dag");
+  // graphviz layout is superlinear, only on request
+  if (clargs.dag_image || clargs.onlyshow)
+  {
+    setup.start();
+    G.show_image(model_dir / "dag");
+    setup.stop("layout");
+  }
   std::cout << G.summary() << std::endl;
-  graph_descr << G.summary() << std::endl << G;
+  if (auto graph_descr = artifact_file(model_dir, "graph", "txt"))
+    artifacts.post(
+        [graph_descr, &G, full = clargs.artifacts == pdr::Artifacts::full]()
+        {
+          *graph_descr << G.summary() << std::endl;
+          if (full)
+            *graph_descr << G;
+        });
 
   // create model from DAG graph and set up algorithm
   if (clargs.max_pebbles < 1)
-    clargs.max_pebbles = G.nodes.size();
+    clargs.max_pebbles = G.size();
 
+  setup.start();
   PDRModel model(clargs.model_name, G, clargs.max_pebbles);
-  model.show(model_descr);
+  setup.stop("model build");
+  if (auto model_descr = artifact_file(model_dir, "model", "txt"))
+  {
+    if (clargs.artifacts == pdr::Artifacts::full)
+    {
+      auto snapshot = std::make_shared<pdr::ExprSnapshot>(model.shown());
+      artifacts.post([model_descr, snapshot]()
+                     { PDRModel::show(*model_descr, snapshot->get()); });
+    }
+    else
+      *model_descr << fmt::format("Literals: {}\nTransition clauses: {}",
+                                  model.literals.size(),
+                                  model.get_transition().size())
+                   << std::endl;
+  }
+  show_bound(model);
 
   if (clargs.onlyshow)
     return 0;
 
+  if (clargs.max_pebbles < model.get_lower_bound().pebbles)
+  {
+    std::cout << fmt::format("No strategy for {} pebbles", clargs.max_pebbles)
+              << std::endl;
+    return 0;
+  }
+
   std::ofstream stats       = trunc_file(base_dir, filename, "stats");
   std::ofstream strategy    = trunc_file(base_dir, filename, "strategy");
-  std::ofstream solver_dump = trunc_file(base_dir, "solver_dump", "strategy");
+  std::shared_ptr<std::ofstream> solver_dump;
+  if (clargs.artifacts == pdr::Artifacts::full)
+    solver_dump = artifact_file(base_dir, "solver_dump", "strategy");
+  std::ofstream frames_dump;
+  if (clargs.dump_frames)
+    frames_dump = trunc_file(base_dir, filename, "frames");
 
   // initialize logger and other bookkeeping
   fs::path log_file      = base_dir / fmt::format("{}.{}", filename, "log");
-  fs::path progress_file = base_dir / fmt::format("{}.{}", filename, "log");
+  fs::path progress_file = base_dir / fmt::format("{}.{}", filename, "out");
 
   pdr::Logger pdr_logger(log_file.string(), G, progress_file.string(),
                          clargs.verbosity);
+  setup.record(pdr_logger.profiler);
+  if (clargs.perf_counters && !pdr_logger.profiler.count_hardware())
+    std::cerr << "Hardware counters unavailable: "
+              << pdr_logger.profiler.hardware_error() << std::endl;
+#ifdef LOG
+  // render with trace-decode
+  fs::path trace_file = base_dir / fmt::format("{}.{}", filename, "trace");
+  pdr_logger.start_trace(trace_file.string(), model.literals);
+#endif
+  if (!clargs.trace_events.empty())
+    pdr_logger.timeline.enable();
+  if (!clargs.record_queries.empty())
+    pdr_logger.record_queries(clargs.record_queries);
+  if (clargs.progress)
+  {
+    fs::path snapshot_file =
+        base_dir / fmt::format("{}.{}", filename, "progress.jsonl");
+    pdr_logger.start_monitor(snapshot_file.string(), clargs.progress_period,
+                             clargs.progress_every);
+  }
   pdr::PDResults res(model);
 
   // run pdr and write output
   show_header(clargs);
-  if (clargs.opt)
-  {
-    pdr::PDR algorithm(model, clargs.delta, pdr_logger, res);
-
-    while (true)
-    {
-      bool found_strategy = !algorithm.run(clargs.opt);
-      stats << "Cardinality: " << model.get_max_pebbles() << std::endl;
-      stats << pdr_logger.stats << std::endl;
-
-      if (!found_strategy || clargs.one)
-        break;
-
-      if (algorithm.decrement(true))
-        break;
-    }
-    algorithm.show_results(strategy);
-    algorithm.show_solver(solver_dump, clargs.max_pebbles);
-  }
+  if (clargs.delta)
+    run<pdr::DeltaPolicy>(clargs, model, pdr_logger, res, stats, strategy,
+                          artifacts, solver_dump, frames_dump);
   else
-  {
-    // TODO multiple normal runs from comparision
-    while (true)
-    {
-      pdr::PDR algorithm(model, clargs.delta, pdr_logger, res);
-      bool found_strategy = !algorithm.run(clargs.opt);
-      stats << "Cardinality: " << model.get_max_pebbles() << std::endl;
-      stats << pdr_logger.stats << std::endl;
+    run<pdr::FatPolicy>(clargs, model, pdr_logger, res, stats, strategy,
+                        artifacts, solver_dump, frames_dump);
 
-      algorithm.show_solver(solver_dump, model.get_max_pebbles());
+  stats << pdr_logger.profiler << std::endl;
+  std::ofstream folded = trunc_file(base_dir, filename, "folded");
+  pdr_logger.profiler.collapsed(folded);
 
-      if (clargs.one)
-        break;
+  if (pdr_logger.timeline.enabled())
+  {
+    std::ofstream trace_events(clargs.trace_events, std::fstream::trunc);
+    if (!trace_events.is_open())
+      throw std::runtime_error("Failed to open " + clargs.trace_events);
+    pdr_logger.timeline.write(trace_events);
+  }
 
-      if (!found_strategy && algorithm.decrement(true))
-      {
-        algorithm.show_results(strategy);
-        break;
-      }
-    }
+  if (!clargs.bench_summary.empty())
+  {
+    std::ofstream summary(clargs.bench_summary, std::fstream::trunc);
+    if (!summary.is_open())
+      throw std::runtime_error("Failed to open " + clargs.bench_summary);
+    summary << fmt::format("{{\"solver_calls\": {}, \"obligations\": {}",
+                           pdr_logger.stats.solver_calls.total_count,
+                           pdr_logger.stats.obligations_handled.total_count);
+    // only counted when built with ALLOC_STATS
+    if (pdr_logger.profiler.counts_allocs())
+      summary << fmt::format(", \"allocations\": {}",
+                             pdr_logger.profiler.total_allocs().count);
+    summary << "}" << std::endl;
   }
   return 0;
 }
@@ -0,0 +1,409 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fmt/format.h>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+// runs a suite of pebbling-pdr configurations and records their cost as json,
+// or compares two such result files.
+// usage:
+//   pebbling-bench run <suite> <results.json> [--runs N] [--warmup N]
+//                  [--exe PATH]
+//   pebbling-bench compare <base.json> <new.json> [--threshold PCT]
+//
+// a suite has one configuration per line: a name and the arguments to
+// pebbling-pdr. '#' starts a comment. the line
+//   tfc-list <list file> <dir> [arguments]
+// adds a configuration for every .tfc file named in the list file. a metric
+// that pebbling-pdr does not report, such as allocations without
+// ALLOC_STATS, is left out of the results
+namespace
+{
+  struct Config
+  {
+    std::string name;
+    std::vector<std::string> args;
+  };
+
+  // the measurements of all runs of a configuration, in order
+  struct Result
+  {
+    std::string name;
+    std::string args;
+    int exit_code = 0;
+    std::map<std::string, std::vector<double>> samples;
+  };
+
+  // the metrics of a run, in the order they are written
+  const std::vector<std::string> metrics = {
+    "wall", "cpu", "rss_kb", "solver_calls", "obligations", "allocations"
+  };
+
+  std::vector<std::string> split(const std::string& line)
+  {
+    std::istringstream ss(line);
+    std::vector<std::string> words;
+    for (std::string w; ss >> w;)
+      words.push_back(w);
+    return words;
+  }
+
+  std::string join(const std::vector<std::string>& words)
+  {
+    std::string rv;
+    for (const std::string& w : words)
+      rv += (rv.empty() ? "" : " ") + w;
+    return rv;
+  }
+
+  std::vector<Config> read_suite(const std::string& filename)
+  {
+    std::ifstream in(filename);
+    if (!in.is_open())
+      throw std::runtime_error("Failed to open " + filename);
+
+    std::vector<Config> suite;
+    for (std::string line; std::getline(in, line);)
+    {
+      line = line.substr(0, line.find('#'));
+      std::vector<std::string> words = split(line);
+      if (words.empty())
+        continue;
+
+      if (words[0] != "tfc-list")
+      {
+        suite.push_back({ words[0], { words.begin() + 1, words.end() } });
+        continue;
+      }
+
+      if (words.size() < 3)
+        throw std::invalid_argument("tfc-list needs a list file and a dir");
+      if (access(words[2].c_str(), F_OK) != 0)
+        throw std::runtime_error("No model dir " + words[2] +
+                                 ", see the suite for where to get it");
+      std::ifstream list(words[1]);
+      if (!list.is_open())
+        throw std::runtime_error("Failed to open " + words[1]);
+      for (std::string model; std::getline(list, model);)
+      {
+        size_t ext = model.rfind(".tfc");
+        if (ext == std::string::npos)
+          continue; // header text
+        model = model.substr(0, ext);
+        std::vector<std::string> args = { "--dir", words[2], "--tfc", model };
+        args.insert(args.end(), words.begin() + 3, words.end());
+        suite.push_back({ model, args });
+      }
+    }
+    return suite;
+  }
+
+  // runs exe with args, without output. fills in the metrics of r
+  int run_once(const std::string& exe, const Config& c, Result& r,
+               bool record)
+  {
+    char summary_file[] = "/tmp/pebbling-bench-XXXXXX";
+    int fd              = mkstemp(summary_file);
+    if (fd < 0)
+      throw std::runtime_error("Failed to create a summary file");
+    close(fd);
+
+    std::vector<std::string> args = { exe };
+    args.insert(args.end(), c.args.begin(), c.args.end());
+    args.insert(args.end(), { "--bench-summary", summary_file });
+    std::vector<char*> argv;
+    for (std::string& a : args)
+      argv.push_back(a.data());
+    argv.push_back(nullptr);
+
+    auto start = std::chrono::steady_clock::now();
+    pid_t pid  = fork();
+    if (pid < 0)
+      throw std::runtime_error("fork failed");
+    if (pid == 0)
+    {
+      int null = open("/dev/null", O_WRONLY);
+      dup2(null, STDOUT_FILENO);
+      dup2(null, STDERR_FILENO);
+      execv(argv[0], argv.data());
+      _exit(127);
+    }
+
+    int status;
+    rusage usage;
+    if (wait4(pid, &status, 0, &usage) < 0)
+      throw std::runtime_error("wait4 failed");
+    std::chrono::duration<double> wall(std::chrono::steady_clock::now() -
+                                       start);
+    int code = WIFEXITED(status) ? WEXITSTATUS(status) : -WTERMSIG(status);
+
+    std::ifstream in(summary_file);
+    std::string summary((std::istreambuf_iterator<char>(in)),
+                        std::istreambuf_iterator<char>());
+    std::remove(summary_file);
+    if (!record)
+      return code;
+
+    auto seconds = [](const timeval& t) { return t.tv_sec + t.tv_usec / 1e6; };
+    // a flat object of numbers, as written by pebbling-pdr --bench-summary.
+    // keys that are not in it are not recorded
+    auto field = [&summary, &r](const std::string& key)
+    {
+      size_t i = summary.find("\"" + key + "\":");
+      if (i != std::string::npos)
+        r.samples[key].push_back(
+            std::strtod(summary.c_str() + i + key.size() + 3, nullptr));
+    };
+    r.samples["wall"].push_back(wall.count());
+    r.samples["cpu"].push_back(seconds(usage.ru_utime) +
+                               seconds(usage.ru_stime));
+    r.samples["rss_kb"].push_back(usage.ru_maxrss);
+    field("solver_calls");
+    field("obligations");
+    field("allocations");
+    return code;
+  }
+
+  std::string show(const Result& r)
+  {
+    std::string rv = fmt::format("{{\"name\": \"{}\", \"args\": \"{}\", "
+                                 "\"exit\": {}",
+                                 r.name, r.args, r.exit_code);
+    for (const std::string& m : metrics)
+    {
+      auto it = r.samples.find(m);
+      if (it == r.samples.end())
+        continue;
+      std::string values;
+      for (double x : it->second)
+        values += fmt::format("{}{}", values.empty() ? "" : ", ", x);
+      rv += fmt::format(", \"{}\": [{}]", m, values);
+    }
+    return rv + "}";
+  }
+
+  // reads a file written by run: one result per line
+  std::vector<Result> read_results(const std::string& filename)
+  {
+    std::ifstream in(filename);
+    if (!in.is_open())
+      throw std::runtime_error("Failed to open " + filename);
+
+    std::vector<Result> results;
+    for (std::string line; std::getline(in, line);)
+    {
+      size_t i = line.find("{\"name\": \"");
+      if (i == std::string::npos)
+        continue;
+      Result r;
+      i += 10;
+      r.name = line.substr(i, line.find('"', i) - i);
+      for (const std::string& m : metrics)
+      {
+        size_t begin = line.find("\"" + m + "\": [");
+        if (begin == std::string::npos)
+          continue;
+        begin += m.size() + 5;
+        std::istringstream values(
+            line.substr(begin, line.find(']', begin) - begin));
+        for (std::string x; std::getline(values, x, ',');)
+          r.samples[m].push_back(std::strtod(x.c_str(), nullptr));
+      }
+      results.push_back(std::move(r));
+    }
+    return results;
+  }
+
+  struct Summary
+  {
+    double mean = 0, var = 0;
+    size_t n = 0;
+  };
+
+  Summary summarize(const std::vector<double>& xs)
+  {
+    Summary s;
+    s.n = xs.size();
+    if (s.n == 0)
+      return s;
+    for (double x : xs)
+      s.mean += x / s.n;
+    for (double x : xs)
+      s.var += (x - s.mean) * (x - s.mean) / std::max<size_t>(1, s.n - 1);
+    return s;
+  }
+
+  // two-sided 95% critical value of student's t for dof degrees of freedom
+  double t_critical(double dof)
+  {
+    static const double table[] = { 12.71, 4.303, 3.182, 2.776, 2.571,
+                                    2.447, 2.365, 2.306, 2.262, 2.228,
+                                    2.201, 2.179, 2.160, 2.145, 2.131 };
+    if (dof < 1)
+      return table[0];
+    if (dof <= 15)
+      return table[static_cast<size_t>(dof) - 1];
+    return dof <= 30 ? 2.042 : 1.960;
+  }
+
+  // welch's t-test. returns if the difference of the means is significant
+  bool significant(const Summary& a, const Summary& b)
+  {
+    if (a.n < 2 || b.n < 2)
+      return false;
+    double va = a.var / a.n, vb = b.var / b.n;
+    if (va + vb == 0)
+      return a.mean != b.mean;
+    double t   = (b.mean - a.mean) / std::sqrt(va + vb);
+    double dof = (va + vb) * (va + vb) /
+                 (va * va / (a.n - 1) + vb * vb / (b.n - 1));
+    return std::abs(t) > t_critical(dof);
+  }
+
+  int run(const std::string& suite_file, const std::string& out_file,
+          unsigned runs, unsigned warmup, const std::string& exe)
+  {
+    std::vector<Config> suite = read_suite(suite_file);
+    std::ofstream out(out_file, std::fstream::trunc);
+    if (!out.is_open())
+      throw std::runtime_error("Failed to open " + out_file);
+
+    out << fmt::format("{{\"suite\": \"{}\", \"runs\": {}, \"warmup\": {}, "
+                       "\"results\": [\n",
+                       suite_file, runs, warmup);
+    int failures = 0;
+    for (size_t i = 0; i < suite.size(); i++)
+    {
+      const Config& c = suite[i];
+      Result r;
+      r.name = c.name;
+      r.args = join(c.args);
+      for (unsigned w = 0; w < warmup; w++)
+        run_once(exe, c, r, false);
+      for (unsigned j = 0; j < runs && r.exit_code == 0; j++)
+        r.exit_code = run_once(exe, c, r, true);
+      failures += r.exit_code != 0;
+
+      Summary wall = summarize(r.samples["wall"]);
+      std::cerr << fmt::format("{:<32} wall {:>9.3f}s +- {:<8.3f} exit {}",
+                               c.name, wall.mean, std::sqrt(wall.var),
+                               r.exit_code)
+                << std::endl;
+      out << show(r) << (i + 1 < suite.size() ? ",\n" : "\n");
+      out.flush();
+    }
+    out << "]}" << std::endl;
+    return failures > 0;
+  }
+
+  int compare(const std::string& base_file, const std::string& new_file,
+              double threshold)
+  {
+    std::vector<Result> base = read_results(base_file);
+    std::vector<Result> next = read_results(new_file);
+
+    int regressions = 0;
+    std::cout << fmt::format("{:<32} {:<13} {:>12} {:>12} {:>8}  {}", "name",
+                             "metric", "base", "new", "change", "verdict")
+              << std::endl;
+    for (const Result& b : base)
+    {
+      auto n = std::find_if(next.begin(), next.end(),
+                            [&b](const Result& r) { return r.name == b.name; });
+      if (n == next.end())
+      {
+        std::cout << fmt::format("{:<32} missing in {}", b.name, new_file)
+                  << std::endl;
+        continue;
+      }
+
+      for (const std::string& m : metrics)
+      {
+        if (!b.samples.count(m) || !n->samples.count(m))
+          continue;
+        Summary sb = summarize(b.samples.at(m));
+        Summary sn = summarize(n->samples.at(m));
+        double change = sb.mean == 0 ? 0 : (sn.mean - sb.mean) / sb.mean;
+
+        std::string verdict = "";
+        if (std::abs(change) * 100 >= threshold && significant(sb, sn))
+        {
+          verdict = change < 0 ? "better" : "worse";
+          regressions += change > 0;
+        }
+        std::cout << fmt::format("{:<32} {:<13} {:>12.4g} {:>12.4g} {:>+7.1f}%"
+                                 "  {}",
+                                 b.name, m, sb.mean, sn.mean, change * 100,
+                                 verdict)
+                  << std::endl;
+      }
+    }
+    return regressions > 0;
+  }
+
+  int usage()
+  {
+    std::cerr << "usage: pebbling-bench run <suite> <results.json> [--runs N] "
+                 "[--warmup N] [--exe PATH]"
+              << std::endl
+              << "       pebbling-bench compare <base.json> <new.json> "
+                 "[--threshold PCT]"
+              << std::endl;
+    return 2;
+  }
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  if (argc < 4)
+    return usage();
+
+  std::string mode(argv[1]);
+  unsigned runs = 5, warmup = 1;
+  double threshold = 5.0;
+  std::string exe  = "./pebbling-pdr";
+  for (int i = 4; i < argc; i += 2)
+  {
+    std::string opt(argv[i]);
+    if (i + 1 == argc)
+      return usage();
+    if (opt == "--runs")
+      runs = std::atoi(argv[i + 1]);
+    else if (opt == "--warmup")
+      warmup = std::atoi(argv[i + 1]);
+    else if (opt == "--exe")
+      exe = argv[i + 1];
+    else if (opt == "--threshold")
+      threshold = std::atof(argv[i + 1]);
+    else
+      return usage();
+  }
+
+  try
+  {
+    if (mode == "run")
+      return run(argv[2], argv[3], runs, warmup, exe);
+    if (mode == "compare")
+      return compare(argv[2], argv[3], threshold);
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << e.what() << std::endl;
+    return 2;
+  }
+  return usage();
+}
@@ -0,0 +1,307 @@
+#include "query-log.h"
+#include "stats.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <fmt/format.h>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <z3++.h>
+
+// re-executes a solver log of pebbling-pdr --record-queries, and reports the
+// time of every check against the time in the recorded run.
+// usage: query-replay <log> [key=value ...] [--csv FILE]
+// a key=value sets a z3 parameter of every solver, after the recorded ones
+namespace
+{
+  using namespace pdr;
+  using namespace pdr::queries;
+
+  class Reader
+  {
+   private:
+    std::ifstream& in;
+
+   public:
+    Reader(std::ifstream& i) : in(i) {}
+
+    template <typename T> T get()
+    {
+      T x;
+      if (!in.read(reinterpret_cast<char*>(&x), sizeof(T)))
+        throw std::runtime_error("truncated log");
+      return x;
+    }
+
+    std::string str()
+    {
+      std::string s(get<uint32_t>(), '\0');
+      if (!in.read(s.data(), s.size()))
+        throw std::runtime_error("truncated log");
+      return s;
+    }
+  };
+
+  void set_param(z3::solver& s, const std::string& key,
+                 const std::string& value)
+  {
+    if (value == "true" || value == "false")
+      s.set(key.c_str(), value == "true");
+    else if (value.find_first_not_of("0123456789") == std::string::npos)
+      s.set(key.c_str(), static_cast<unsigned>(std::stoul(value)));
+    else
+      s.set(key.c_str(), value.c_str());
+  }
+
+  // every expression of the log, in order. the declarations and expressions
+  // are parsed as one script, so each constant is declared once instead of
+  // for every expression. reads in to the end of the log
+  std::vector<z3::expr> read_expressions(Reader& r, std::ifstream& in,
+                                         z3::context& ctx)
+  {
+    std::string script;
+    size_t n_exprs = 0;
+    while (in.peek() != EOF)
+    {
+      switch (static_cast<Op>(r.get<uint8_t>()))
+      {
+        case Op::declare:
+          script += "(declare-fun |" + r.str() + "| () Bool)\n";
+          break;
+        case Op::expr:
+          script += "(assert " + r.str() + ")\n";
+          n_exprs++;
+          break;
+        case Op::solver: r.get<uint32_t>(); break;
+        case Op::param:
+          r.get<uint32_t>();
+          r.str();
+          r.str();
+          break;
+        case Op::add:
+          r.get<uint32_t>();
+          r.get<uint32_t>();
+          break;
+        case Op::reset: r.get<uint32_t>(); break;
+        case Op::check:
+        {
+          r.get<uint32_t>();
+          uint32_t n = r.get<uint32_t>();
+          for (uint32_t i = 0; i < n; i++)
+            r.get<uint32_t>();
+          r.get<uint8_t>();
+          r.get<double>();
+          break;
+        }
+        default: throw std::runtime_error("unknown operation");
+      }
+    }
+
+    z3::expr_vector parsed = ctx.parse_string(script.c_str());
+    if (parsed.size() != n_exprs)
+      throw std::runtime_error(fmt::format(
+          "parsed {} of {} expressions", parsed.size(), n_exprs));
+    std::vector<z3::expr> rv;
+    rv.reserve(n_exprs);
+    for (const z3::expr& e : parsed)
+      rv.push_back(e);
+    return rv;
+  }
+
+  const char* result_name(uint8_t r)
+  {
+    return r == Result::sat ? "sat" : r == Result::unsat ? "unsat" : "unknown";
+  }
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  if (argc < 2)
+  {
+    std::cerr << "usage: query-replay <log> [key=value ...] [--csv FILE]"
+              << std::endl;
+    return 1;
+  }
+
+  std::vector<std::pair<std::string, std::string>> overrides;
+  std::ofstream csv;
+  for (int i = 2; i < argc; i++)
+  {
+    std::string arg(argv[i]);
+    if (arg == "--csv" && i + 1 < argc)
+    {
+      csv.open(argv[++i], std::ios::trunc);
+      csv << "check,solver,assumptions,result,seconds,replay_result,"
+             "replay_seconds"
+          << std::endl;
+      continue;
+    }
+    size_t eq = arg.find('=');
+    if (eq == std::string::npos)
+    {
+      std::cerr << "expected key=value: " << arg << std::endl;
+      return 1;
+    }
+    overrides.emplace_back(arg.substr(0, eq), arg.substr(eq + 1));
+  }
+
+  std::ifstream in(argv[1], std::ios::binary);
+  if (!in.is_open())
+  {
+    std::cerr << "Failed to open " << argv[1] << std::endl;
+    return 1;
+  }
+  Reader r(in);
+  if (r.get<uint32_t>() != magic || r.get<uint32_t>() != version)
+  {
+    std::cerr << argv[1] << " is not a version " << version
+              << " pdr query log" << std::endl;
+    return 1;
+  }
+
+  z3::context ctx;
+  std::vector<z3::expr> exprs;
+  try
+  {
+    exprs = read_expressions(r, in, ctx);
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << "reading expressions: " << e.what() << std::endl;
+    return 1;
+  }
+  // replay the operations from the first record
+  in.clear();
+  in.seekg(2 * sizeof(uint32_t));
+
+  std::vector<std::unique_ptr<z3::solver>> solvers;
+  // parameters are set after the recorded ones, at the first query
+  std::vector<bool> overridden;
+  auto solver = [&](uint32_t i) -> z3::solver&
+  {
+    z3::solver& s = *solvers.at(i);
+    if (!overridden.at(i))
+    {
+      for (auto& [key, value] : overrides)
+        set_param(s, key, value);
+      overridden[i] = true;
+    }
+    return s;
+  };
+
+  // [recorded result][replayed result]
+  std::array<std::array<Histogram, 3>, 3> latency, recorded;
+  double total = 0, recorded_total = 0;
+  size_t n_checks = 0, n_mismatches = 0;
+  std::vector<Z3_ast> assumptions;
+  try
+  {
+    while (in.peek() != EOF)
+    {
+      switch (static_cast<Op>(r.get<uint8_t>()))
+      {
+        case Op::declare: // parsed by read_expressions
+        case Op::expr: r.str(); break;
+        case Op::solver:
+          r.get<uint32_t>();
+          solvers.push_back(std::make_unique<z3::solver>(ctx));
+          overridden.push_back(false);
+          break;
+        case Op::param:
+        {
+          uint32_t s      = r.get<uint32_t>();
+          std::string key = r.str();
+          set_param(*solvers.at(s), key, r.str());
+          break;
+        }
+        case Op::add:
+        {
+          uint32_t s = r.get<uint32_t>();
+          solver(s).add(exprs.at(r.get<uint32_t>()));
+          break;
+        }
+        case Op::reset:
+        {
+          uint32_t s = r.get<uint32_t>();
+          solvers.at(s)->reset();
+          overridden.at(s) = false;
+          break;
+        }
+        case Op::check:
+        {
+          uint32_t s = r.get<uint32_t>();
+          uint32_t n = r.get<uint32_t>();
+          assumptions.clear();
+          for (uint32_t i = 0; i < n; i++)
+            assumptions.push_back(exprs.at(r.get<uint32_t>()));
+          uint8_t result = r.get<uint8_t>();
+          double seconds = r.get<double>();
+
+          z3::solver& z = solver(s);
+          auto start    = std::chrono::steady_clock::now();
+          Z3_lbool l    = Z3_solver_check_assumptions(ctx, z, n,
+                                                      assumptions.data());
+          ctx.check_error();
+          std::chrono::duration<double> dt(std::chrono::steady_clock::now() -
+                                           start);
+          uint8_t replayed = l == Z3_L_TRUE    ? Result::sat
+                             : l == Z3_L_FALSE ? Result::unsat
+                                               : Result::unknown;
+
+          latency.at(result).at(replayed).add(dt.count() * 1e9);
+          recorded.at(result).at(replayed).add(seconds * 1e9);
+          total += dt.count();
+          recorded_total += seconds;
+          n_mismatches += result != replayed;
+          if (csv.is_open())
+            csv << fmt::format("{},{},{},{},{},{},{}", n_checks, s, n,
+                               result_name(result), seconds,
+                               result_name(replayed), dt.count())
+                << '\n';
+          n_checks++;
+          break;
+        }
+        default: throw std::runtime_error("unknown operation");
+      }
+    }
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << "after " << n_checks << " checks: " << e.what() << std::endl;
+    return 1;
+  }
+
+  std::cout << fmt::format("{} solvers, {} expressions, {} checks, {} with a "
+                           "different result",
+                           solvers.size(), exprs.size(), n_checks,
+                           n_mismatches)
+            << std::endl;
+  std::cout << fmt::format("total check time: recorded {:.3f}s, replayed "
+                           "{:.3f}s",
+                           recorded_total, total)
+            << std::endl;
+  std::cout << "latency (us) recorded -> replayed result:" << std::endl;
+  for (uint8_t a = 0; a < 3; a++)
+    for (uint8_t b = 0; b < 3; b++)
+    {
+      const Histogram& h = latency[a][b];
+      if (h.total_count == 0)
+        continue;
+      const Histogram& old = recorded[a][b];
+      auto us              = [](uint64_t ns) { return ns / 1000.0; };
+      std::cout << fmt::format("- {:>7} -> {:<7}: n={:<8} p50={:<10} "
+                               "p99={:<10} max={:<10} (recorded p50={} "
+                               "p99={})",
+                               result_name(a), result_name(b), h.total_count,
+                               us(h.percentile(0.5)), us(h.percentile(0.99)),
+                               us(h.max), us(old.percentile(0.5)),
+                               us(old.percentile(0.99)))
+                << std::endl;
+    }
+  return n_mismatches > 0;
+}
@@ -0,0 +1,141 @@
+#include "lit.h"
+#include "trace-format.h"
+
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <fmt/chrono.h>
+#include <fmt/format.h>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// renders a binary trace from the Tracer in the text format of the spdlog
+// trace log.
+// usage: trace-decode <trace file> [log file]
+namespace
+{
+  using namespace pdr;
+
+  template <typename T> bool read(std::istream& in, T& x)
+  {
+    return bool(in.read(reinterpret_cast<char*>(&x), sizeof(T)));
+  }
+
+  // literal names in the format of z3, as in str::extend::join
+  std::string show_cube(const std::vector<std::string>& names,
+                        const std::vector<uint32_t>& cube)
+  {
+    std::string rv;
+    for (size_t i = 0; i < cube.size(); i++)
+    {
+      if (i > 0)
+        rv += ", ";
+
+      uint32_t l = cube[i];
+      if (l == trace::no_lit)
+      {
+        rv += "<expr>";
+        continue;
+      }
+      bool primed      = l & trace::primed;
+      Lit lit          = l & ~trace::primed;
+      std::string name = names.at(lit_var(lit)) + (primed ? ".p" : "");
+      rv += lit_sign(lit) ? fmt::format("(not {})", name) : name;
+    }
+    return rv;
+  }
+
+  // the prefix of the default spdlog pattern
+  std::string prefix(int64_t ns)
+  {
+    using namespace std::chrono;
+    std::time_t seconds = ns / 1000000000;
+    unsigned millis     = (ns / 1000000) % 1000;
+    return fmt::format("[{:%Y-%m-%d %H:%M:%S}.{:03}] [pdr_logger] [trace] ",
+                       fmt::localtime(seconds), millis);
+  }
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  if (argc < 2)
+  {
+    std::cerr << "usage: trace-decode <trace file> [log file]" << std::endl;
+    return 1;
+  }
+
+  std::ifstream in(argv[1], std::ios::binary);
+  if (!in.is_open())
+  {
+    std::cerr << "Failed to open " << argv[1] << std::endl;
+    return 1;
+  }
+
+  std::ofstream file;
+  if (argc > 2)
+    file.open(argv[2], std::ios::trunc);
+  std::ostream& out = argc > 2 ? file : std::cout;
+
+  trace::Header header;
+  if (!read(in, header) || header.magic != trace::magic ||
+      header.version != trace::version)
+  {
+    std::cerr << argv[1] << " is not a version " << trace::version
+              << " pdr trace" << std::endl;
+    return 1;
+  }
+
+  std::vector<std::string> names(header.n_vars);
+  for (std::string& name : names)
+  {
+    uint32_t length;
+    read(in, length);
+    name.resize(length);
+    in.read(name.data(), length);
+  }
+
+  trace::RecordHead r;
+  std::vector<uint32_t> cube;
+  size_t n_records = 0;
+  while (read(in, r))
+  {
+    cube.resize(r.n_lits);
+    if (!in.read(reinterpret_cast<char*>(cube.data()),
+                 r.n_lits * sizeof(uint32_t)))
+    {
+      std::cerr << "truncated record after " << n_records << " records"
+                << std::endl;
+      return 1;
+    }
+    if (r.event >= static_cast<uint16_t>(trace::Event::N))
+    {
+      std::cerr << "unknown event " << r.event << std::endl;
+      return 1;
+    }
+
+    std::string pre(prefix(header.start_ns + r.time_ns));
+    std::string tab(r.indent, '\t');
+    std::string cube_str(show_cube(names, cube));
+
+    std::string_view format(trace::formats[r.event]);
+    size_t begin = 0;
+    while (true)
+    {
+      size_t end = format.find('\n', begin);
+      std::string_view line = format.substr(begin, end - begin);
+      out << pre
+          << fmt::format(fmt::runtime(line), tab, r.a, r.b, cube_str)
+          << '\n';
+      if (end == std::string_view::npos)
+        break;
+      begin = end + 1;
+    }
+    n_records++;
+  }
+
+  std::cerr << "decoded " << n_records << " records" << std::endl;
+  return 0;
+}